@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+#include "settings_helper.h"
+#include "configmanagerstandin.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <DConfig>
+
+DCORE_USE_NAMESPACE
+using namespace benchmark;
+
+/*
+ * DConfig with FileBackend below a temporary local prefix and with
+ * DBusBackend against ConfigManagerStandIn on a private bus.
+ */
+class BenchDConfig : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void load_data();
+    void load();
+    void read_data();
+    void read();
+    void write_data();
+    void write();
+    void memory_data();
+    void memory();
+
+private:
+    void addBackendRows();
+    DConfig *createConfig();
+
+    QTemporaryDir m_dir;
+    QScopedPointer<ConfigManagerStandIn> m_configManager;
+    bool m_dbusAvailable = false;
+};
+
+static constexpr char const *FileBackendType = "FileBackend";
+static constexpr char const *DBusBackendType = "DBusBackend";
+static constexpr char const *DataDir = "/usr/share/dsg";
+
+static QString configName(int count)
+{
+    return QString("bench-dconfig-%1").arg(count);
+}
+
+static QStringList configKeys(int count)
+{
+    QStringList keys;
+    keys.reserve(count);
+    for (int i = 0; i < count; ++i)
+        keys << QString("key%1").arg(i);
+    return keys;
+}
+
+void BenchDConfig::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    qputenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX", m_dir.path().toLocal8Bit());
+    qputenv("DSG_DATA_DIRS", DataDir);
+
+    QHash<QString, QStringList> keys;
+    for (int count : {SmallSchema, LargeSchema}) {
+        keys.insert(configName(count), configKeys(count));
+        const QString &metaPath = QString("%1%2/configs/%3/%4.json")
+                .arg(m_dir.path(), DataDir, QCoreApplication::applicationName(), configName(count));
+        QVERIFY(writeFile(metaPath, dconfigMeta(configKeys(count))));
+    }
+
+    m_configManager.reset(new ConfigManagerStandIn(keys));
+    m_dbusAvailable = m_configManager->start();
+    if (!m_dbusAvailable)
+        qWarning() << "DBusBackend is skipped, the private bus isn't available.";
+}
+
+void BenchDConfig::cleanupTestCase()
+{
+    m_configManager.reset();
+
+    qunsetenv("DSG_DCONFIG_BACKEND_TYPE");
+    qunsetenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX");
+    qunsetenv("DSG_DATA_DIRS");
+}
+
+void BenchDConfig::addBackendRows()
+{
+    QTest::addColumn<QString>("backend");
+    QTest::addColumn<int>("count");
+
+    for (const char *type : {FileBackendType, DBusBackendType}) {
+        for (int count : {SmallSchema, LargeSchema})
+            QTest::addRow("%s/%d", type, count) << QString(type) << count;
+    }
+}
+
+DConfig *BenchDConfig::createConfig()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+
+    if (backend == DBusBackendType && !m_dbusAvailable)
+        return nullptr;
+
+    qputenv("DSG_DCONFIG_BACKEND_TYPE", backend.toLocal8Bit());
+    return DConfig::create(QCoreApplication::applicationName(), configName(count));
+}
+
+void BenchDConfig::load_data()
+{
+    addBackendRows();
+}
+
+void BenchDConfig::load()
+{
+    QScopedPointer<DConfig> probe(createConfig());
+    if (!probe)
+        QSKIP("The backend isn't available.");
+    probe.reset();
+
+    QBENCHMARK {
+        QScopedPointer<DConfig> config(createConfig());
+        config->keyList();
+    }
+}
+
+void BenchDConfig::read_data()
+{
+    addBackendRows();
+}
+
+void BenchDConfig::read()
+{
+    QScopedPointer<DConfig> config(createConfig());
+    if (!config)
+        QSKIP("The backend isn't available.");
+    QVERIFY(config->isValid());
+    const QStringList &keys = config->keyList();
+
+    QBENCHMARK {
+        for (const QString &key : keys)
+            config->value(key);
+    }
+}
+
+void BenchDConfig::write_data()
+{
+    addBackendRows();
+}
+
+void BenchDConfig::write()
+{
+    QScopedPointer<DConfig> config(createConfig());
+    if (!config)
+        QSKIP("The backend isn't available.");
+    QVERIFY(config->isValid());
+    const QStringList &keys = config->keyList();
+
+    int value = 0;
+    QBENCHMARK {
+        ++value;
+        for (const QString &key : keys)
+            config->setValue(key, value);
+    }
+    QCOMPARE(config->value(keys.last()).toInt(), value);
+}
+
+void BenchDConfig::memory_data()
+{
+    addBackendRows();
+}
+
+void BenchDConfig::memory()
+{
+    const qint64 before = residentMemory();
+    QScopedPointer<DConfig> config(createConfig());
+    if (!config)
+        QSKIP("The backend isn't available.");
+    QVERIFY(config->isValid());
+    const qint64 after = residentMemory();
+
+    QTest::setBenchmarkResult(qMax<qint64>(after - before, 0), QTest::BytesAllocated);
+}
+
+DTK_BENCHMARK(BenchDConfig)
+
+#include "bench_dconfig.moc"
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+
+#include <QTest>
+
+#include "filesystem/private/dfilesystemwatcher_linux_p.h"
+
+#include <malloc.h>
+
+DCORE_USE_NAMESPACE
+
+/*
+ * parse: replays a burst of synthetic inotify events, like an archive
+ * extracted into watched directories, through the deduplication of one read
+ * in DFileSystemWatcher. A third of the events repeats an earlier one.
+ *
+ * watchTable: the heap used by the watch descriptor table of 100k watches,
+ * compared with the QMultiHash<int, QString> it replaced, and the time to
+ * look up the paths of every watch.
+ */
+class BenchDFileSystemWatcher : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void parse_data();
+    void parse();
+
+    void watchTable_data();
+    void watchTable();
+};
+
+static constexpr int DirectoryCount = 100;
+
+static void appendEvent(QByteArray &buffer, int wd, quint32 mask, quint32 cookie, const QByteArray &name)
+{
+    const quint32 len = (name.size() + sizeof(inotify_event)) & ~(sizeof(inotify_event) - 1);
+    inotify_event event{wd, mask, cookie, len};
+    buffer.append(reinterpret_cast<const char *>(&event), sizeof(event));
+    buffer.append(name);
+    buffer.append(QByteArray(int(len) - name.size(), '\0'));
+}
+
+void BenchDFileSystemWatcher::parse_data()
+{
+    QTest::addColumn<int>("eventCount");
+
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+void BenchDFileSystemWatcher::parse()
+{
+    QFETCH(int, eventCount);
+
+    DInotifyWatchTable watches;
+    for (int i = 1; i <= DirectoryCount; ++i)
+        watches.insert(i, true, QString("/tmp/bench/dir-%1").arg(i));
+
+    // created, modified and modified again: the last one is a duplicate.
+    QByteArray buffer;
+    for (int i = 0; i < eventCount; ++i) {
+        const int file = i / 3;
+        const QByteArray &name = "file-" + QByteArray::number(file);
+        appendEvent(buffer, file % DirectoryCount + 1, i % 3 ? IN_MODIFY : IN_CREATE, 0, name);
+    }
+
+    QBENCHMARK {
+        DInotifyEventBatch batch(watches);
+        batch.parse(buffer.constData(), buffer.size());
+        QCOMPARE(batch.events.size() + batch.duplicateCount, eventCount);
+    }
+}
+
+static constexpr int WatchCount = 100000;
+
+static size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return size_t(mallinfo().uordblks);
+#endif
+}
+
+void BenchDFileSystemWatcher::watchTable_data()
+{
+    QTest::addColumn<bool>("table");
+    QTest::addColumn<QString>("metric");
+
+    for (const char *metric : {"memory", "lookup"}) {
+        QTest::newRow(qPrintable(QString("multihash/%1").arg(metric))) << false << QString(metric);
+        QTest::newRow(qPrintable(QString("table/%1").arg(metric))) << true << QString(metric);
+    }
+}
+
+void BenchDFileSystemWatcher::watchTable()
+{
+    QFETCH(bool, table);
+    QFETCH(QString, metric);
+
+    // the paths are shared with pathToID, they aren't counted.
+    QStringList paths;
+    paths.reserve(WatchCount);
+    for (int i = 1; i <= WatchCount; ++i)
+        paths << QString("/tmp/bench/dir-%1").arg(i);
+
+    const size_t heap = heapInUse();
+    DInotifyWatchTable watches;
+    QMultiHash<int, QString> idToPath;
+    for (int i = 1; i <= WatchCount; ++i) {
+        if (table)
+            watches.insert(i, true, paths.at(i - 1));
+        else
+            idToPath.insert(-i, paths.at(i - 1));
+    }
+
+    if (metric == QLatin1String("memory")) {
+        QTest::setBenchmarkResult(qreal(heapInUse() - heap), QTest::BytesAllocated);
+        return;
+    }
+
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (int wd = 1; wd <= WatchCount; ++wd) {
+            if (table) {
+                found += watches.paths(wd).size();
+            } else {
+                // what the event batch did for a directory.
+                QList<QString> values = idToPath.values(wd);
+                if (values.isEmpty())
+                    values = idToPath.values(-wd);
+                found += values.size();
+            }
+        }
+    }
+    QCOMPARE(found, WatchCount);
+}
+
+DTK_BENCHMARK(BenchDFileSystemWatcher)
+
+#include "bench_dfilesystemwatcher.moc"
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <DFileWatcher>
+
+#include <memory>
+#include <vector>
+
+DCORE_USE_NAMESPACE
+
+/*
+ * The time from writing a file until its DFileWatcher reports the change,
+ * while 1, 1000 or 10000 watchers of other files in the same directory are
+ * running. The event must only reach the watchers of the file and of its
+ * directory, the others mustn't slow it down.
+ */
+class BenchDFileWatcher : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void dispatch_data();
+    void dispatch();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+static qint64 maxUserWatches()
+{
+    QFile file("/proc/sys/fs/inotify/max_user_watches");
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+    return file.readAll().trimmed().toLongLong();
+}
+
+void BenchDFileWatcher::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+void BenchDFileWatcher::dispatch_data()
+{
+    QTest::addColumn<int>("watchers");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void BenchDFileWatcher::dispatch()
+{
+    QFETCH(int, watchers);
+
+    // a watch per file and one for each ancestor directory.
+    if (maxUserWatches() < watchers + 64)
+        QSKIP("fs.inotify.max_user_watches is too low");
+
+    std::vector<std::unique_ptr<DFileWatcher>> others;
+    others.reserve(watchers);
+    for (int i = 0; i < watchers; ++i) {
+        const QString &path = m_dir.filePath(QString("other-%1").arg(i));
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.close();
+
+        others.emplace_back(new DFileWatcher(path));
+        if (!others.back()->startWatcher())
+            QSKIP("not enough inotify watches");
+    }
+
+    const QString &path = m_dir.filePath("watched");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    DFileWatcher watcher(path);
+    QVERIFY(watcher.startWatcher());
+
+    int modified = 0;
+    connect(&watcher, &DBaseFileWatcher::fileModified, this, [&modified] { ++modified; });
+
+    QBENCHMARK {
+        const int expected = modified + 1;
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write("x");
+        file.close();
+
+        QElapsedTimer timer;
+        timer.start();
+        while (modified < expected && timer.elapsed() < 5000)
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents, 10);
+        QVERIFY(modified >= expected);
+    }
+}
+
+DTK_BENCHMARK(BenchDFileWatcher)
+
+#include "bench_dfilewatcher.moc"
@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+#include "settings_helper.h"
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "settings/dsettings.h"
+#include "settings/backend/qsettingbackend.h"
+#include "settings/backend/dsettingsdconfigbackend.h"
+
+DCORE_USE_NAMESPACE
+using namespace benchmark;
+
+/*
+ * DSettings with QSettingBackend and DSettingsDConfigBackend, the latter
+ * uses the DConfig FileBackend below a temporary local prefix.
+ */
+class BenchDSettings : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void load_data();
+    void load();
+    void read_data();
+    void read();
+    void backendRead_data();
+    void backendRead();
+    void write_data();
+    void write();
+    void backendWrite_data();
+    void backendWrite();
+    void memory_data();
+    void memory();
+
+private:
+    void addBackendRows();
+    DSettingsBackend *createBackend(const QString &type, int count);
+
+    QTemporaryDir m_dir;
+    int m_backendIndex = 0;
+};
+
+static constexpr char const *QSettingsType = "QSettingBackend";
+static constexpr char const *DConfigType = "DSettingsDConfigBackend";
+static constexpr char const *DataDir = "/usr/share/dsg";
+
+static QString dconfigName(int count)
+{
+    return QString("bench-dsettings-%1").arg(count);
+}
+
+void BenchDSettings::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    qputenv("DSG_DCONFIG_BACKEND_TYPE", "FileBackend");
+    qputenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX", m_dir.path().toLocal8Bit());
+    qputenv("DSG_DATA_DIRS", DataDir);
+
+    for (int count : {SmallSchema, LargeSchema}) {
+        const QString &metaPath = QString("%1%2/configs/%3/%4.json")
+                .arg(m_dir.path(), DataDir, QCoreApplication::applicationName(), dconfigName(count));
+        QVERIFY(writeFile(metaPath, dconfigMeta(settingsKeys(count))));
+    }
+}
+
+void BenchDSettings::cleanupTestCase()
+{
+    qunsetenv("DSG_DCONFIG_BACKEND_TYPE");
+    qunsetenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX");
+    qunsetenv("DSG_DATA_DIRS");
+}
+
+void BenchDSettings::addBackendRows()
+{
+    QTest::addColumn<QString>("backend");
+    QTest::addColumn<int>("count");
+
+    for (const char *type : {QSettingsType, DConfigType}) {
+        for (int count : {SmallSchema, LargeSchema})
+            QTest::addRow("%s/%d", type, count) << QString(type) << count;
+    }
+}
+
+DSettingsBackend *BenchDSettings::createBackend(const QString &type, int count)
+{
+    if (type == QSettingsType)
+        return new QSettingBackend(m_dir.filePath(QString("settings-%1.conf").arg(m_backendIndex++)));
+
+    return new DSettingsDConfigBackend(dconfigName(count));
+}
+
+/*
+ * setBackend() moves the backend to a new write thread, which quits when
+ * settings is destroyed. Delete the backend in that thread, and the thread
+ * itself by processing the deferred deletes, as there is no event loop here.
+ */
+static void releaseSettings(DSettings *settings, DSettingsBackend *backend)
+{
+    backend->deleteLater();
+    delete settings;
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+void BenchDSettings::load_data()
+{
+    addBackendRows();
+}
+
+void BenchDSettings::load()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+    const QByteArray &schema = settingsSchema(count);
+
+    QBENCHMARK {
+        auto settings = DSettings::fromJson(schema);
+        auto settingsBackend = createBackend(backend, count);
+        settings->setBackend(settingsBackend);
+        releaseSettings(settings.data(), settingsBackend);
+    }
+}
+
+void BenchDSettings::read_data()
+{
+    addBackendRows();
+}
+
+void BenchDSettings::read()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+    QScopedPointer<DSettings> settings(DSettings::fromJson(settingsSchema(count)).data());
+    auto settingsBackend = createBackend(backend, count);
+    settings->setBackend(settingsBackend);
+    const QStringList &keys = settingsKeys(count);
+
+    QBENCHMARK {
+        for (const QString &key : keys)
+            settings->value(key);
+    }
+    releaseSettings(settings.take(), settingsBackend);
+}
+
+void BenchDSettings::backendRead_data()
+{
+    addBackendRows();
+}
+
+void BenchDSettings::backendRead()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+    QScopedPointer<DSettingsBackend> settingsBackend(createBackend(backend, count));
+    const QStringList &keys = settingsKeys(count);
+
+    QBENCHMARK {
+        for (const QString &key : keys)
+            settingsBackend->getOption(key);
+    }
+}
+
+void BenchDSettings::write_data()
+{
+    addBackendRows();
+}
+
+void BenchDSettings::write()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+    QScopedPointer<DSettings> settings(DSettings::fromJson(settingsSchema(count)).data());
+    auto settingsBackend = createBackend(backend, count);
+    settings->setBackend(settingsBackend);
+    const QStringList &keys = settingsKeys(count);
+
+    int value = 0;
+    QBENCHMARK {
+        ++value;
+        for (const QString &key : keys)
+            settings->setOption(key, value);
+        settings->sync();
+    }
+    // wait the backend thread to store all values.
+    releaseSettings(settings.take(), settingsBackend);
+}
+
+void BenchDSettings::backendWrite_data()
+{
+    addBackendRows();
+}
+
+void BenchDSettings::backendWrite()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+    QScopedPointer<DSettingsBackend> settingsBackend(createBackend(backend, count));
+    const QStringList &keys = settingsKeys(count);
+
+    int value = 0;
+    QBENCHMARK {
+        ++value;
+        for (const QString &key : keys) {
+            QMetaObject::invokeMethod(settingsBackend.data(), "doSetOption", Qt::DirectConnection,
+                                      Q_ARG(QString, key), Q_ARG(QVariant, value));
+        }
+        QMetaObject::invokeMethod(settingsBackend.data(), "doSync", Qt::DirectConnection);
+    }
+    QCOMPARE(settingsBackend->getOption(keys.last()).toInt(), value);
+}
+
+void BenchDSettings::memory_data()
+{
+    addBackendRows();
+}
+
+void BenchDSettings::memory()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, count);
+    const QByteArray &schema = settingsSchema(count);
+
+    const qint64 before = residentMemory();
+    QScopedPointer<DSettings> settings(DSettings::fromJson(schema).data());
+    auto settingsBackend = createBackend(backend, count);
+    settings->setBackend(settingsBackend);
+    const qint64 after = residentMemory();
+    releaseSettings(settings.take(), settingsBackend);
+
+    QTest::setBenchmarkResult(qMax<qint64>(after - before, 0), QTest::BytesAllocated);
+}
+
+DTK_BENCHMARK(BenchDSettings)
+
+#include "bench_dsettings.moc"
@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+#include "settings_helper.h"
+
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "settings/dsettings.h"
+#include "settings/backend/gsettingsbackend.h"
+
+DCORE_USE_NAMESPACE
+using namespace benchmark;
+
+static constexpr char const *SchemaId = "com.deepin.dtk.benchmark%1";
+static constexpr char const *SchemaPath = "/com/deepin/dtk/benchmark%1/";
+
+/*
+ * DSettings with GSettingsBackend on the in-memory gsettings backend,
+ * the gsettings schemas are compiled into a temporary directory.
+ */
+class BenchGSettingsBackend : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void load_data();
+    void load();
+    void read_data();
+    void read();
+    void write_data();
+    void write();
+    void memory_data();
+    void memory();
+
+private:
+    void addRows();
+    QByteArray schema(int count) const;
+
+    QTemporaryDir m_dir;
+};
+
+void BenchGSettingsBackend::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    for (int count : {SmallSchema, LargeSchema}) {
+        QString xml = QString("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<schemalist>"
+                              "<schema id=\"%1\" path=\"%2\">").arg(QString(SchemaId).arg(count),
+                                                                   QString(SchemaPath).arg(count));
+        for (int i = 0; i < count; ++i)
+            xml += QString("<key name=\"base-group-key%1\" type=\"i\"><default>0</default></key>").arg(i);
+        xml += "</schema></schemalist>";
+
+        QVERIFY(writeFile(m_dir.filePath(QString(SchemaId).arg(count) + ".gschema.xml"), xml.toUtf8()));
+    }
+
+    if (QProcess::execute("glib-compile-schemas", {m_dir.path()}) != 0)
+        QSKIP("glib-compile-schemas is not available");
+
+    qputenv("GSETTINGS_SCHEMA_DIR", m_dir.path().toLocal8Bit());
+    qputenv("GSETTINGS_BACKEND", "memory");
+}
+
+void BenchGSettingsBackend::cleanupTestCase()
+{
+    qunsetenv("GSETTINGS_SCHEMA_DIR");
+    qunsetenv("GSETTINGS_BACKEND");
+}
+
+void BenchGSettingsBackend::addRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::addRow("%d", SmallSchema) << int(SmallSchema);
+    QTest::addRow("%d", LargeSchema) << int(LargeSchema);
+}
+
+QByteArray BenchGSettingsBackend::schema(int count) const
+{
+    return settingsSchema(count, QJsonObject{{"gsettings", QJsonObject{
+        {"id", QString(SchemaId).arg(count)}, {"path", QString(SchemaPath).arg(count)}}}});
+}
+
+void BenchGSettingsBackend::load_data()
+{
+    addRows();
+}
+
+void BenchGSettingsBackend::load()
+{
+    QFETCH(int, count);
+    const QByteArray &json = schema(count);
+
+    QBENCHMARK {
+        auto settings = DSettings::fromJson(json);
+        auto backend = new GSettingsBackend(settings);
+        settings->setBackend(backend);
+        delete settings;
+        delete backend;
+    }
+}
+
+void BenchGSettingsBackend::read_data()
+{
+    addRows();
+}
+
+void BenchGSettingsBackend::read()
+{
+    QFETCH(int, count);
+    QScopedPointer<DSettings> settings(DSettings::fromJson(schema(count)).data());
+    QScopedPointer<GSettingsBackend> backend(new GSettingsBackend(settings.data()));
+    const QStringList &keys = settingsKeys(count);
+
+    QBENCHMARK {
+        for (const QString &key : keys)
+            backend->getOption(key);
+    }
+}
+
+void BenchGSettingsBackend::write_data()
+{
+    addRows();
+}
+
+void BenchGSettingsBackend::write()
+{
+    QFETCH(int, count);
+    QScopedPointer<DSettings> settings(DSettings::fromJson(schema(count)).data());
+    QScopedPointer<GSettingsBackend> backend(new GSettingsBackend(settings.data()));
+    const QStringList &keys = settingsKeys(count);
+
+    int value = 0;
+    QBENCHMARK {
+        ++value;
+        for (const QString &key : keys) {
+            QMetaObject::invokeMethod(backend.data(), "doSetOption", Qt::DirectConnection,
+                                      Q_ARG(QString, key), Q_ARG(QVariant, value));
+        }
+        QMetaObject::invokeMethod(backend.data(), "doSync", Qt::DirectConnection);
+    }
+    QCOMPARE(backend->getOption(keys.last()).toInt(), value);
+}
+
+void BenchGSettingsBackend::memory_data()
+{
+    addRows();
+}
+
+void BenchGSettingsBackend::memory()
+{
+    QFETCH(int, count);
+    const QByteArray &json = schema(count);
+
+    const qint64 before = residentMemory();
+    QScopedPointer<DSettings> settings(DSettings::fromJson(json).data());
+    QScopedPointer<GSettingsBackend> backend(new GSettingsBackend(settings.data()));
+    const qint64 after = residentMemory();
+
+    QTest::setBenchmarkResult(qMax<qint64>(after - before, 0), QTest::BytesAllocated);
+}
+
+DTK_BENCHMARK(BenchGSettingsBackend)
+
+#include "bench_gsettingsbackend.moc"
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+
+#include <QDateTime>
+#include <QTest>
+
+#include <AbstractStringAppender.h>
+
+#include "log/LogFormatter.h"
+
+DCORE_USE_NAMESPACE
+
+#define DEFAULT_FMT "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}"
+
+// formats a record the way AbstractStringAppender does for every message.
+class InterpretedFormatAppender : public AbstractStringAppender
+{
+public:
+    QString format(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                   const char *function, const QString &category, const QString &message) const
+    {
+        return formattedString(time, level, file, line, function, category, message);
+    }
+
+protected:
+    void append(const QDateTime &, Logger::LogLevel, const char *, int,
+                const char *, const QString &, const QString &) override {}
+};
+
+/*
+ * Messages formatted per second with the format interpreted for every
+ * message (AbstractStringAppender) and with the compiled LogFormatter.
+ */
+class BenchLogFormat : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void format_data();
+    void format();
+};
+
+static constexpr int MessageCount = 10000;
+
+void BenchLogFormat::format_data()
+{
+    QTest::addColumn<bool>("compiled");
+    QTest::addColumn<QString>("logFormat");
+
+    QTest::newRow("interpreted/default") << false << QString(DEFAULT_FMT);
+    QTest::newRow("compiled/default") << true << QString(DEFAULT_FMT);
+    QTest::newRow("interpreted/message") << false << QString("%{message}");
+    QTest::newRow("compiled/message") << true << QString("%{message}");
+}
+
+void BenchLogFormat::format()
+{
+    QFETCH(bool, compiled);
+    QFETCH(QString, logFormat);
+
+    InterpretedFormatAppender appender;
+    appender.setFormat(logFormat);
+    LogFormatter formatter(logFormat);
+    const QString message("The quick brown fox jumps over the lazy dog");
+
+    qint64 bytes = 0;
+    QBENCHMARK {
+        // a new timestamp for every message as Logger does.
+        for (int i = 0; i < MessageCount; ++i) {
+            const QDateTime &time = QDateTime::currentDateTime();
+            const QString &line = compiled
+                    ? formatter.formatted(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, "dtk.bench", message)
+                    : appender.format(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, "dtk.bench", message);
+            bytes += line.size();
+        }
+    }
+    QVERIFY(bytes > 0);
+}
+
+DTK_BENCHMARK(BenchLogFormat)
+
+#include "bench_logformat.moc"
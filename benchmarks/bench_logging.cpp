@@ -0,0 +1,326 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QPair>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <LogManager.h>
+
+#include "log/AsyncAppender.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+DCORE_USE_NAMESPACE
+
+#define DEFAULT_FMT "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}"
+#define CUSTOM_FMT "%{time}{HH:mm:ss} %{category} %{message}"
+
+/*
+ * Messages per second and the p50/p99 latency of a qCDebug() call for every
+ * appender DLogManager registers, with 1, 4 and 16 producer threads, for an
+ * enabled and a disabled category and with the default and a custom format.
+ *
+ * DLogManager can't unregister its appenders, so every configuration is
+ * measured in a child process of the benchmark, which sets the format with
+ * DLogManager::setLogFormat() and registers the appender with the
+ * DLogManager::register*Appender() call of its name, with the default options.
+ * The messages go through the Qt message handler.
+ *
+ * The rows aren't QBENCHMARK loops: a configuration is measured once and the
+ * numbers are reported with QTest::setBenchmarkResult() in three rows, so that
+ * `-o result.csv,csv` gives machine readable results to compare between
+ * releases:
+ *   <appender>/<category>/<format>/<threads>/msgs-per-sec  Events, messages per second
+ *   <appender>/<category>/<format>/<threads>/p50           WalltimeNanoseconds, the median call
+ *   <appender>/<category>/<format>/<threads>/p99           WalltimeNanoseconds, the 99th percentile call
+ * The tools reading the output show p50 and p99 as the time per iteration,
+ * they are the latency of a single qCDebug() call, and every row has one
+ * iteration.
+ *
+ * The console appender writes to /dev/null, so that the terminal isn't measured.
+ * A disabled category costs about as much as reading the clock, which is
+ * included in the latencies.
+ */
+class BenchLogging : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void write_data();
+    void write();
+
+private:
+    struct Result
+    {
+        double messagesPerSecond = 0;
+        qint64 p50 = 0;
+        qint64 p99 = 0;
+    };
+
+    Result measure(const QString &appenderName, bool enabled, const QString &format, int threads);
+    static Result measureHere(const QString &appenderName, bool enabled, const QString &format, int threads);
+
+    QTemporaryDir m_dir;
+    QHash<QString, Result> m_results;
+};
+
+static constexpr int MessagesPerThread = 2000;
+// a child process measuring a configuration is given it and the file of its result in these.
+static constexpr char ChildConfigurationEnv[] = "DTK_BENCH_LOGGING_CONFIGURATION";
+static constexpr char ChildResultEnv[] = "DTK_BENCH_LOGGING_RESULT";
+static constexpr int ChildTimeout = 5 * 60 * 1000;
+
+static QStringList appenderNames()
+{
+    QStringList names{"console", "file", "asyncfile", "binaryfile", "flightrecorder"};
+#if defined(BUILD_WITH_SYSTEMD) && defined(Q_OS_LINUX)
+    names << "journal";
+#endif
+    return names;
+}
+
+// the binary appenders don't format the records.
+static bool isFormatted(const QString &appenderName)
+{
+    return appenderName != QLatin1String("binaryfile") && appenderName != QLatin1String("flightrecorder");
+}
+
+// redirects stderr to /dev/null while it lives.
+class DiscardStderr
+{
+public:
+    DiscardStderr()
+        : m_saved(::dup(STDERR_FILENO))
+    {
+        fflush(stderr);
+        const int null = ::open("/dev/null", O_WRONLY);
+        if (null >= 0) {
+            ::dup2(null, STDERR_FILENO);
+            ::close(null);
+        }
+    }
+
+    ~DiscardStderr()
+    {
+        fflush(stderr);
+        if (m_saved >= 0) {
+            ::dup2(m_saved, STDERR_FILENO);
+            ::close(m_saved);
+        }
+    }
+
+private:
+    int m_saved;
+};
+
+void BenchLogging::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    // the child measures the configuration it's given, and skips the rows.
+    const QString &configuration = qEnvironmentVariable(ChildConfigurationEnv);
+    if (configuration.isEmpty())
+        return;
+
+    const QStringList &fields = configuration.split('\n');
+    QCOMPARE(fields.size(), 4);
+    const Result &result = measureHere(fields.at(0), fields.at(1) == QLatin1String("enabled"), fields.at(2), fields.at(3).toInt());
+
+    QFile file(qEnvironmentVariable(ChildResultEnv));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray::number(result.messagesPerSecond, 'f') + ' ' + QByteArray::number(result.p50) + ' '
+               + QByteArray::number(result.p99));
+    file.close();
+    QSKIP("measured in a child process");
+}
+
+void BenchLogging::write_data()
+{
+    QTest::addColumn<QString>("appender");
+    QTest::addColumn<bool>("enabled");
+    QTest::addColumn<QString>("logFormat");
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<QString>("metric");
+
+    const QList<QPair<QString, QString>> formats{{"default", DEFAULT_FMT}, {"custom", CUSTOM_FMT}};
+    for (const QString &appender : appenderNames()) {
+        for (bool enabled : {true, false}) {
+            for (const auto &format : formats) {
+                // the format doesn't matter if nothing is written.
+                if (format.first != QLatin1String("default") && (!enabled || !isFormatted(appender)))
+                    continue;
+
+                for (int threads : {1, 4, 16}) {
+                    const QString &name = QString("%1/%2/%3/%4").arg(appender, enabled ? "enabled" : "disabled", format.first).arg(threads);
+                    for (const char *metric : {"msgs-per-sec", "p50", "p99"}) {
+                        QTest::newRow(qPrintable(name + '/' + metric))
+                                << appender << enabled << format.second << threads << QString(metric);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BenchLogging::write()
+{
+    QFETCH(QString, appender);
+    QFETCH(bool, enabled);
+    QFETCH(QString, logFormat);
+    QFETCH(int, threads);
+    QFETCH(QString, metric);
+
+    // the rows of a configuration share one measurement.
+    const QString &key = QString(QTest::currentDataTag()).section('/', 0, 3);
+    auto it = m_results.find(key);
+    if (it == m_results.end())
+        it = m_results.insert(key, measure(appender, enabled, logFormat, threads));
+
+    QVERIFY(it->messagesPerSecond > 0);
+    if (metric == QLatin1String("msgs-per-sec"))
+        QTest::setBenchmarkResult(it->messagesPerSecond, QTest::Events);
+    else if (metric == QLatin1String("p50"))
+        QTest::setBenchmarkResult(it->p50, QTest::WalltimeNanoseconds);
+    else
+        QTest::setBenchmarkResult(it->p99, QTest::WalltimeNanoseconds);
+}
+
+BenchLogging::Result BenchLogging::measure(const QString &appenderName, bool enabled, const QString &format, int threads)
+{
+    const QString &resultPath = m_dir.filePath("result");
+    QFile::remove(resultPath);
+    // the log files of the previous configuration.
+    QDir(m_dir.filePath("cache")).removeRecursively();
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    const QStringList configuration{appenderName, enabled ? "enabled" : "disabled", format, QString::number(threads)};
+    environment.insert(ChildConfigurationEnv, configuration.join('\n'));
+    environment.insert(ChildResultEnv, resultPath);
+    environment.insert("XDG_CACHE_HOME", m_dir.filePath("cache"));
+    // the rules of DConfig aren't waited for.
+    environment.insert("DTK_DISABLED_LOGGING_RULES", "1");
+
+    QProcess child;
+    child.setProcessEnvironment(environment);
+    child.setStandardOutputFile(QProcess::nullDevice());
+    child.start(QCoreApplication::applicationFilePath(), {metaObject()->className()});
+    if (!child.waitForFinished(ChildTimeout) || child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0) {
+        child.kill();
+        child.waitForFinished();
+        return Result();
+    }
+
+    QFile file(resultPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return Result();
+
+    const QList<QByteArray> &numbers = file.readAll().split(' ');
+    if (numbers.size() != 3)
+        return Result();
+
+    Result result;
+    result.messagesPerSecond = numbers.at(0).toDouble();
+    result.p50 = numbers.at(1).toLongLong();
+    result.p99 = numbers.at(2).toLongLong();
+    return result;
+}
+
+BenchLogging::Result BenchLogging::measureHere(const QString &appenderName, bool enabled, const QString &format, int threads)
+{
+    QLoggingCategory category(enabled ? "dtk.bench.enabled" : "dtk.bench.disabled");
+    category.setEnabled(QtDebugMsg, enabled);
+
+    DLogManager::setLogFormat(format);
+    if (appenderName == QLatin1String("console"))
+        DLogManager::registerConsoleAppender();
+    else if (appenderName == QLatin1String("file"))
+        DLogManager::registerFileAppender();
+    else if (appenderName == QLatin1String("asyncfile"))
+        DLogManager::registerAsyncFileAppender();
+    else if (appenderName == QLatin1String("binaryfile"))
+        DLogManager::registerBinaryFileAppender();
+    else if (appenderName == QLatin1String("flightrecorder"))
+        DLogManager::registerFlightRecorderAppender();
+    else if (appenderName == QLatin1String("journal"))
+        DLogManager::registerJournalAppender();
+    else
+        return Result();
+
+    QScopedPointer<DiscardStderr> discardStderr;
+    if (appenderName == QLatin1String("console"))
+        discardStderr.reset(new DiscardStderr);
+
+    const QString message("The quick brown fox jumps over the lazy dog");
+    std::vector<std::vector<qint64>> latencies(threads);
+    std::vector<std::thread> producers;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    for (int i = 0; i < threads; ++i) {
+        producers.emplace_back([&, i] {
+            std::vector<qint64> &samples = latencies[i];
+            samples.reserve(MessagesPerThread);
+            ++ready;
+            while (!go.load())
+                std::this_thread::yield();
+
+            for (int n = 0; n < MessagesPerThread; ++n) {
+                const auto begin = std::chrono::steady_clock::now();
+                qCDebug(category).noquote() << message;
+                const auto end = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            }
+        });
+    }
+    while (ready.load() < threads)
+        std::this_thread::yield();
+
+    QElapsedTimer timer;
+    timer.start();
+    go = true;
+    for (std::thread &producer : producers)
+        producer.join();
+    // the records are written when the async appender is done with them.
+    AsyncAppender::flushAll();
+    const qint64 elapsed = qMax<qint64>(timer.nsecsElapsed(), 1);
+
+    discardStderr.reset();
+
+    std::vector<qint64> all;
+    all.reserve(size_t(threads) * MessagesPerThread);
+    for (const std::vector<qint64> &samples : latencies)
+        all.insert(all.end(), samples.begin(), samples.end());
+
+    const auto percentile = [&all](int p) {
+        auto nth = all.begin() + qMin<qint64>(qint64(all.size()) * p / 100, qint64(all.size()) - 1);
+        std::nth_element(all.begin(), nth, all.end());
+        return *nth;
+    };
+
+    Result result;
+    result.messagesPerSecond = double(all.size()) * 1e9 / double(elapsed);
+    result.p50 = percentile(50);
+    result.p99 = percentile(99);
+    return result;
+}
+
+DTK_BENCHMARK(BenchLogging)
+
+#include "bench_logging.moc"
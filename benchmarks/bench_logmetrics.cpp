@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+
+#include <QDateTime>
+#include <QTest>
+
+#include "log/LogMetrics.h"
+
+DCORE_USE_NAMESPACE
+
+// does nothing, so only the cost of the metrics is measured.
+class NullAppender : public AbstractAppender
+{
+protected:
+    void append(const QDateTime &, Logger::LogLevel, const char *, int,
+                const char *, const QString &, const QString &) override {}
+};
+
+/*
+ * The cost of the log metrics: a record written to an appender directly and
+ * through CategoryMetricsAppender and InstrumentedAppender as DLogManager does.
+ */
+class BenchLogMetrics : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void write_data();
+    void write();
+};
+
+static constexpr int MessageCount = 10000;
+
+void BenchLogMetrics::write_data()
+{
+    QTest::addColumn<bool>("metrics");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("metrics") << true;
+}
+
+void BenchLogMetrics::write()
+{
+    QFETCH(bool, metrics);
+
+    NullAppender plain;
+    CategoryMetricsAppender categories;
+    InstrumentedAppender instrumented("bench.null", new NullAppender);
+    const QString message("The quick brown fox jumps over the lazy dog");
+    const QDateTime time = QDateTime::currentDateTime();
+
+    QBENCHMARK {
+        for (int i = 0; i < MessageCount; ++i) {
+            const QString &category = i % 4 ? QStringLiteral("dtk.bench") : QStringLiteral("dtk.bench.other");
+            if (metrics) {
+                categories.write(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, category, message);
+                instrumented.write(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, category, message);
+            } else {
+                plain.write(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, category, message);
+            }
+        }
+    }
+}
+
+DTK_BENCHMARK(BenchLogMetrics)
+
+#include "bench_logmetrics.moc"
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QFile>
+
+namespace benchmark {
+
+using Factory = QObject *(*)();
+
+inline QList<Factory> &registry()
+{
+    static QList<Factory> factories;
+    return factories;
+}
+
+struct Registrar
+{
+    explicit Registrar(Factory factory) { registry().append(factory); }
+};
+
+// Resident set size of this process in bytes, 0 if it's unknown.
+inline qint64 residentMemory()
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly))
+        return 0;
+
+    const QByteArrayList &lines = status.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (!line.startsWith("VmRSS:"))
+            continue;
+        // VmRSS:      1234 kB
+        return line.mid(6).trimmed().split(' ').first().toLongLong() * 1024;
+    }
+    return 0;
+}
+
+} // namespace benchmark
+
+#define DTK_BENCHMARK(Class) \
+    static QObject *create##Class() { return new Class; } \
+    static const benchmark::Registrar registrar##Class(&create##Class);
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "configmanagerstandin.h"
+
+#include <QDBusConnectionInterface>
+#include <QDebug>
+
+static constexpr char const *ServiceName = "org.desktopspec.ConfigManager";
+static constexpr char const *ConnectionName = "dtkcore-benchmarks-configmanager";
+
+ConfigManagerStandIn::ConfigManagerStandIn(const QHash<QString, QStringList> &keys)
+    : m_keys(keys)
+{
+}
+
+ConfigManagerStandIn::~ConfigManagerStandIn()
+{
+    stop();
+}
+
+bool ConfigManagerStandIn::start()
+{
+    m_daemon.start("dbus-daemon", {"--session", "--nofork", "--print-address"});
+    if (!m_daemon.waitForStarted() || !m_daemon.waitForReadyRead()) {
+        qWarning() << "Can't start dbus-daemon:" << m_daemon.errorString();
+        return false;
+    }
+    m_address = QString::fromLocal8Bit(m_daemon.readLine()).trimmed();
+    qputenv("DBUS_SYSTEM_BUS_ADDRESS", m_address.toLocal8Bit());
+
+    auto connection = QDBusConnection::connectToBus(m_address, ConnectionName);
+    if (!connection.isConnected()) {
+        qWarning() << "Can't connect to the private bus:" << connection.lastError().message();
+        return false;
+    }
+
+    moveToThread(&m_thread);
+    m_thread.start();
+
+    if (!connection.registerObject("/", this, QDBusConnection::ExportAllSlots))
+        return false;
+    return connection.registerService(ServiceName);
+}
+
+void ConfigManagerStandIn::stop()
+{
+    if (m_address.isEmpty())
+        return;
+
+    QDBusConnection::disconnectFromBus(ConnectionName);
+    m_thread.quit();
+    m_thread.wait();
+    m_daemon.kill();
+    m_daemon.waitForFinished();
+    m_address.clear();
+}
+
+QDBusObjectPath ConfigManagerStandIn::acquireManager(const QString &appid, const QString &name, const QString &subpath)
+{
+    Q_UNUSED(appid)
+    Q_UNUSED(subpath)
+
+    // every DConfig gets its own manager object as the real service does.
+    const QString &path = QString("/benchmark/manager%1").arg(m_managerCount++);
+    auto manager = new ConfigManagerObjectStandIn(m_keys.value(name), this);
+    QDBusConnection(ConnectionName).registerObject(path, manager,
+                                                   QDBusConnection::ExportAllSlots
+                                                   | QDBusConnection::ExportAllSignals
+                                                   | QDBusConnection::ExportAllProperties);
+    return QDBusObjectPath(path);
+}
+
+void ConfigManagerStandIn::update(const QString &path)
+{
+    Q_UNUSED(path)
+}
+
+void ConfigManagerStandIn::sync(const QString &path)
+{
+    Q_UNUSED(path)
+}
+
+ConfigManagerObjectStandIn::ConfigManagerObjectStandIn(const QStringList &keys, QObject *parent)
+    : QObject(parent)
+{
+    for (const QString &key : keys)
+        m_defaultValues.insert(key, 0);
+    m_values = m_defaultValues;
+}
+
+QDBusVariant ConfigManagerObjectStandIn::value(const QString &key) const
+{
+    return QDBusVariant(m_values.value(key));
+}
+
+bool ConfigManagerObjectStandIn::isDefaultValue(const QString &key) const
+{
+    return m_values.value(key) == m_defaultValues.value(key);
+}
+
+void ConfigManagerObjectStandIn::setValue(const QString &key, const QDBusVariant &value)
+{
+    if (!m_values.contains(key) || m_values.value(key) == value.variant())
+        return;
+
+    m_values.insert(key, value.variant());
+    Q_EMIT valueChanged(key);
+}
+
+void ConfigManagerObjectStandIn::reset(const QString &key)
+{
+    setValue(key, QDBusVariant(m_defaultValues.value(key)));
+}
+
+QString ConfigManagerObjectStandIn::name(const QString &key, const QString &language) const
+{
+    Q_UNUSED(language)
+    return key;
+}
+
+QString ConfigManagerObjectStandIn::description(const QString &key, const QString &language) const
+{
+    Q_UNUSED(key)
+    Q_UNUSED(language)
+    return QString();
+}
+
+QString ConfigManagerObjectStandIn::visibility(const QString &key) const
+{
+    Q_UNUSED(key)
+    return QStringLiteral("private");
+}
+
+QString ConfigManagerObjectStandIn::permissions(const QString &key) const
+{
+    Q_UNUSED(key)
+    return QStringLiteral("readwrite");
+}
+
+void ConfigManagerObjectStandIn::release()
+{
+    // destroyed objects are unregistered by QtDBus.
+    deleteLater();
+}
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QDBusConnection>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+#include <QHash>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QThread>
+#include <QVariantMap>
+
+/*
+ * A minimal org.desktopspec.ConfigManager on a private dbus-daemon, DConfig's
+ * DBusBackend reaches it as the system bus through DBUS_SYSTEM_BUS_ADDRESS.
+ * The service objects run in their own thread since DBusBackend blocks on
+ * its calls.
+ */
+class ConfigManagerStandIn : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.desktopspec.ConfigManager")
+public:
+    // `keys` of every configuration name served.
+    explicit ConfigManagerStandIn(const QHash<QString, QStringList> &keys);
+    ~ConfigManagerStandIn() override;
+
+    // starts the bus and the service, it must be called before the first use of the system bus.
+    bool start();
+    void stop();
+
+public Q_SLOTS:
+    QDBusObjectPath acquireManager(const QString &appid, const QString &name, const QString &subpath);
+    void update(const QString &path);
+    void sync(const QString &path);
+
+private:
+    QHash<QString, QStringList> m_keys;
+    QProcess m_daemon;
+    QThread m_thread;
+    QString m_address;
+    int m_managerCount = 0;
+};
+
+class ConfigManagerObjectStandIn : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.desktopspec.ConfigManager.Manager")
+    Q_PROPERTY(QString version READ version)
+    Q_PROPERTY(QStringList keyList READ keyList)
+public:
+    explicit ConfigManagerObjectStandIn(const QStringList &keys, QObject *parent = nullptr);
+
+    QString version() const { return QStringLiteral("1.0"); }
+    QStringList keyList() const { return m_values.keys(); }
+
+public Q_SLOTS:
+    QDBusVariant value(const QString &key) const;
+    bool isDefaultValue(const QString &key) const;
+    void setValue(const QString &key, const QDBusVariant &value);
+    void reset(const QString &key);
+    QString name(const QString &key, const QString &language) const;
+    QString description(const QString &key, const QString &language) const;
+    QString visibility(const QString &key) const;
+    QString permissions(const QString &key) const;
+    void release();
+
+Q_SIGNALS:
+    void valueChanged(const QString &key);
+
+private:
+    QVariantMap m_values;
+    QVariantMap m_defaultValues;
+};
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark_helper.h"
+
+#include <QCoreApplication>
+#include <QScopedPointer>
+#include <QTest>
+
+// "result.xml" becomes "result-BenchDSettings.xml", the standard output stays.
+static QString classOutputFile(const QString &file, const QString &className)
+{
+    if (file == QLatin1String("-"))
+        return file;
+
+    const int dot = file.lastIndexOf('.');
+    if (dot <= file.lastIndexOf('/') + 1)
+        return file + '-' + className;
+    return file.left(dot) + '-' + className + file.mid(dot);
+}
+
+// every class is run by its own qExec(), which would overwrite the output of the previous one.
+static QStringList classArguments(const QStringList &args, const QString &className)
+{
+    QStringList ret = args;
+    for (int i = 1; i + 1 < ret.size(); ++i) {
+        if (ret.at(i) != QLatin1String("-o"))
+            continue;
+
+        QString &output = ret[++i];
+        const int comma = output.lastIndexOf(',');
+        if (comma < 0)
+            output = classOutputFile(output, className);
+        else
+            output = classOutputFile(output.left(comma), className) + output.mid(comma);
+    }
+    return ret;
+}
+
+/*
+ * dtkcore-benchmarks [BenchmarkClass] [QTest options]
+ *
+ * Runs every registered benchmark class, or only the given one, with the
+ * usual QTest command line, e.g. `-o result.xml,xml` for machine readable
+ * output or `-iterations 100`. Without a class, every class writes its own
+ * output file named after it, e.g. result-BenchDSettings.xml.
+ */
+int main(int argc, char *argv[])
+{
+    qputenv("DSG_APP_ID", "dtkcore-benchmarks");
+
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("dtkcore-benchmarks");
+    app.setOrganizationName("deepin");
+
+    QStringList args = app.arguments();
+    QString only;
+    if (args.size() > 1 && !args.at(1).startsWith('-')) {
+        for (auto factory : benchmark::registry()) {
+            QScopedPointer<QObject> object(factory());
+            if (args.at(1) == object->metaObject()->className()) {
+                only = args.takeAt(1);
+                break;
+            }
+        }
+    }
+
+    int ret = 0;
+    for (auto factory : benchmark::registry()) {
+        QScopedPointer<QObject> object(factory());
+        if (!only.isEmpty() && only != object->metaObject()->className())
+            continue;
+        const QString &className = object->metaObject()->className();
+        ret |= QTest::qExec(object.data(), only.isEmpty() ? classArguments(args, className) : args);
+    }
+    return ret;
+}
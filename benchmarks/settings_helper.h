@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+namespace benchmark {
+
+// small and very large schemas used by the settings and config benchmarks.
+static constexpr int SmallSchema = 16;
+static constexpr int LargeSchema = 5000;
+
+static constexpr char const *DSettingsGroupKey = "base.group";
+
+inline QString settingsKey(int index)
+{
+    return QString("%1.key%2").arg(DSettingsGroupKey).arg(index);
+}
+
+inline QStringList settingsKeys(int count)
+{
+    QStringList keys;
+    keys.reserve(count);
+    for (int i = 0; i < count; ++i)
+        keys << settingsKey(i);
+    return keys;
+}
+
+// DSettings schema with `count` integer options in the group "base.group".
+inline QByteArray settingsSchema(int count, const QJsonObject &extra = QJsonObject())
+{
+    QJsonArray options;
+    for (int i = 0; i < count; ++i) {
+        options.append(QJsonObject{{"key", QString("key%1").arg(i)},
+                                   {"name", QString("Key %1").arg(i)},
+                                   {"type", "spinbutton"},
+                                   {"default", 0}});
+    }
+
+    QJsonObject meta = extra;
+    meta.insert("groups", QJsonArray{QJsonObject{{"key", "base"}, {"name", "Base"}, {"groups", QJsonArray{
+        QJsonObject{{"key", "group"}, {"name", "Group"}, {"options", options}}}}}});
+    return QJsonDocument(meta).toJson(QJsonDocument::Compact);
+}
+
+// DConfig meta with `keys` as integer values.
+inline QByteArray dconfigMeta(const QStringList &keys)
+{
+    QJsonObject contents;
+    for (const QString &key : keys) {
+        contents.insert(key, QJsonObject{{"value", 0},
+                                         {"serial", 0},
+                                         {"flags", QJsonArray()},
+                                         {"name", key},
+                                         {"permissions", "readwrite"},
+                                         {"visibility", "private"}});
+    }
+    return QJsonDocument(QJsonObject{{"magic", "dsg.config.meta"},
+                                     {"version", "1.0"},
+                                     {"contents", contents}}).toJson(QJsonDocument::Compact);
+}
+
+inline bool writeFile(const QString &path, const QByteArray &content)
+{
+    QDir().mkpath(QFileInfo(path).path());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(content) == content.size();
+}
+
+} // namespace benchmark
@@ -20,6 +20,7 @@ set (DSYSINFO_PREFIX "" CACHE STRING "PREFIX of DSysInfo")
 set (BUILD_EXAMPLES ON CACHE BOOL "Build examples")
 set (BUILD_VERSION "0" CACHE STRING "buildversion")
 option(BUIILD_TESTING "Build tests" OFF)
+option(BUILD_BENCHMARKS "Build benchmarks" OFF)
 
 if(UNIX AND NOT APPLE)
   set(LINUX TRUE)
@@ -62,6 +63,9 @@ if(BUILD_TESTING)
   enable_testing()
   add_sub_dir(tests)
 endif()
+if(BUILD_BENCHMARKS AND LINUX)
+  add_sub_dir(benchmarks)
+endif()
 if(BUILD_EXAMPLES)
   message("===================================")
   message("You can build and run examples now ")
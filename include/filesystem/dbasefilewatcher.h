@@ -18,6 +18,23 @@ class LIBDTKCORESHARED_EXPORT DBaseFileWatcher : public QObject, public DObject
     Q_OBJECT
 
 public:
+    enum ChangeFlag {
+        NoChange = 0x0,
+        Modified = 0x1,
+        AttributeChanged = 0x2,
+        Closed = 0x4,
+        Moved = 0x8
+    };
+    Q_DECLARE_FLAGS(ChangeFlags, ChangeFlag)
+    Q_FLAG(ChangeFlags)
+
+    enum DeliveryFlag {
+        LeadingDelivery = 0x1,
+        TrailingDelivery = 0x2
+    };
+    Q_DECLARE_FLAGS(DeliveryFlags, DeliveryFlag)
+    Q_FLAG(DeliveryFlags)
+
     ~DBaseFileWatcher();
 
     QUrl fileUrl() const;
@@ -28,6 +45,10 @@ public:
 
     virtual void setEnabledSubfileWatcher(const QUrl &subfileUrl, bool enabled = true);
 
+    void setCoalescingWindow(int msec, DeliveryFlags delivery = TrailingDelivery);
+    int coalescingWindow() const;
+    DeliveryFlags coalescingDelivery() const;
+
     using SignalType1 = void(DBaseFileWatcher::*)(const QUrl &);
     using SignalType2 = void(DBaseFileWatcher::*)(const QUrl &, const QUrl &);
     static bool ghostSignal(const QUrl &targetUrl, SignalType1 signal, const QUrl &arg1);
@@ -40,6 +61,7 @@ Q_SIGNALS:
     void subfileCreated(const QUrl &url);
     void fileModified(const QUrl &url);
     void fileClosed(const QUrl &url);
+    void fileChanged(const QUrl &url, Dtk::Core::DBaseFileWatcher::ChangeFlags changes);
 
 protected:
     explicit DBaseFileWatcher(DBaseFileWatcherPrivate &dd, const QUrl &url, QObject *parent = 0);
@@ -49,6 +71,9 @@ private:
     D_DECLARE_PRIVATE(DBaseFileWatcher)
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(DBaseFileWatcher::ChangeFlags)
+Q_DECLARE_OPERATORS_FOR_FLAGS(DBaseFileWatcher::DeliveryFlags)
+
 DCORE_END_NAMESPACE
 
 #endif // DBASEFILEWATCHER_H
@@ -27,6 +27,17 @@ public:
     QStringList addPaths(const QStringList &files);
     bool removePath(const QString &file);
     QStringList removePaths(const QStringList &files);
+    bool addRecursivePath(const QString &path);
+
+    void setReaderThreadEnabled(bool enabled);
+    bool isReaderThreadEnabled() const;
+    void setOverflowRecoveryEnabled(bool enabled);
+    bool isOverflowRecoveryEnabled() const;
+
+    void setWatchBudget(int count);
+    int watchBudget() const;
+    int watchCount() const;
+    QStringList polledPaths() const;
 
     QStringList files() const;
     QStringList directories() const;
@@ -7,21 +7,44 @@
 #define LOGMANAGER_H
 
 #include <QScopedPointer>
+#include <QVariantMap>
 
 #include "dtkcore_global.h"
 
 DCORE_BEGIN_NAMESPACE
 
+namespace DUtil {
+class DExportedInterface;
+}
+
 class DLogManagerPrivate;
 class LIBDTKCORESHARED_EXPORT DLogManager
 {
     Q_DISABLE_COPY(DLogManager)
 public:
+    enum OverflowPolicy {
+        BlockWhenFull,
+        DropWhenFull,
+        DropAndCountWhenFull
+    };
+
     static void registerConsoleAppender();
     static void registerFileAppender();
+    static void registerAsyncFileAppender(OverflowPolicy policy = BlockWhenFull, int queueCapacity = 8192);
+    static void registerBinaryFileAppender();
+    static void registerFlightRecorderAppender(int capacity = 4 * 1024 * 1024);
     static void registerJournalAppender();
 
+    static quint64 droppedLogCount();
+
+    static QVariantMap categoryMetrics();
+    static QVariantMap appenderMetrics();
+    static void resetMetrics();
+    static void exportMetrics(DUtil::DExportedInterface *interface);
+
     static QString getlogFilePath();
+    static QString getBinaryLogFilePath();
+    static QString getFlightRecorderFilePath();
 
     /*!
      * \brief setlogFilePath will change log file path of registerFileAppender
@@ -30,10 +53,14 @@ public:
     static void setlogFilePath(const QString &logFilePath);
 
     static void setLogFormat(const QString &format);
+    static void setMaxLogFileSize(qint64 maxFileSize, qint64 diskBudget = 0);
 
 private:
     void initConsoleAppender();
     void initRollingFileAppender();
+    void initAsyncFileAppender(OverflowPolicy policy, int queueCapacity);
+    void initBinaryFileAppender();
+    void initFlightRecorderAppender(int capacity);
     void initJournalAppender();
     QString joinPath(const QString &path, const QString &fileName);
 
@@ -6,6 +6,7 @@
 
 #include <QObject>
 #include <QScopedPointer>
+#include <QVariant>
 
 #include "dsettingsbackend.h"
 
@@ -25,6 +26,7 @@ public:
 protected Q_SLOTS:
     virtual void doSetOption(const QString &key, const QVariant &value) Q_DECL_OVERRIDE;
     virtual void doSync() Q_DECL_OVERRIDE;
+    void doSetOptions(const QVariantMap &values);
 
 private:
     QScopedPointer<QSettingBackendPrivate> d_ptr;
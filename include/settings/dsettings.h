@@ -7,6 +7,7 @@
 #include <QObject>
 #include <QPointer>
 #include <QScopedPointer>
+#include <QVariant>
 
 #include "dtkcore_global.h"
 
@@ -40,8 +41,13 @@ public:
 
     QVariant getOption(const QString &key) const;
 
+    void beginUpdate();
+    void commit();
+    bool isUpdating() const;
+
 Q_SIGNALS:
     void valueChanged(const QString &key, const QVariant &value);
+    void valuesChanged(const QVariantMap &values);
 
 public Q_SLOTS:
     //!
@@ -7,16 +7,130 @@
 
 #include <QEvent>
 #include <QDebug>
+#include <QTimer>
+#include <QVector>
 
 DCORE_BEGIN_NAMESPACE
 
 QList<DBaseFileWatcher*> DBaseFileWatcherPrivate::watcherList;
+QMutex DBaseFileWatcherPrivate::watcherListMutex;
+
 DBaseFileWatcherPrivate::DBaseFileWatcherPrivate(DBaseFileWatcher *qq)
     : DObjectPrivate(qq)
 {
 
 }
 
+QList<DBaseFileWatcher *> DBaseFileWatcherPrivate::watchersOf(const QUrl &url)
+{
+    QList<DBaseFileWatcher *> watchers;
+    QMutexLocker locker(&watcherListMutex);
+    for (DBaseFileWatcher *watcher : std::as_const(watcherList)) {
+        if (watcher->d_func()->url == url)
+            watchers << watcher;
+    }
+    return watchers;
+}
+
+void DBaseFileWatcherPrivate::notifyChanged(const QUrl &url, DBaseFileWatcher::ChangeFlag change)
+{
+    if (coalescingWindow <= 0) {
+        deliverChanges(url, change);
+        return;
+    }
+
+    auto it = pendingChanges.find(url);
+    if (it != pendingChanges.end()) {
+        it->changes |= change;
+        return;
+    }
+
+    // the first change of a quiet file opens the window.
+    const bool leading = coalescingDelivery.testFlag(DBaseFileWatcher::LeadingDelivery);
+    pendingChanges.insert(url, {leading ? DBaseFileWatcher::NoChange : DBaseFileWatcher::ChangeFlags(change),
+                                coalescingClock.elapsed() + coalescingWindow});
+
+    // every window has the same length, a running timer ends before this one.
+    if (!coalescingTimer->isActive())
+        coalescingTimer->start(coalescingWindow);
+
+    if (leading)
+        deliverChanges(url, change);
+}
+
+void DBaseFileWatcherPrivate::notifyMoved(const QUrl &fromUrl, const QUrl &toUrl)
+{
+    Q_Q(DBaseFileWatcher);
+
+    // the changes before the move are reported with it.
+    const PendingChanges pending = pendingChanges.take(fromUrl);
+    deliverChanges(fromUrl, pending.changes | DBaseFileWatcher::Moved);
+    Q_EMIT q->fileMoved(fromUrl, toUrl);
+}
+
+void DBaseFileWatcherPrivate::notifyDeleted(const QUrl &url)
+{
+    Q_Q(DBaseFileWatcher);
+
+    const PendingChanges pending = pendingChanges.take(url);
+    if (pending.changes)
+        deliverChanges(url, pending.changes);
+    Q_EMIT q->fileDeleted(url);
+}
+
+void DBaseFileWatcherPrivate::deliverChanges(const QUrl &url, DBaseFileWatcher::ChangeFlags changes)
+{
+    Q_Q(DBaseFileWatcher);
+
+    if (changes.testFlag(DBaseFileWatcher::Modified))
+        Q_EMIT q->fileModified(url);
+    if (changes.testFlag(DBaseFileWatcher::AttributeChanged))
+        Q_EMIT q->fileAttributeChanged(url);
+    if (changes.testFlag(DBaseFileWatcher::Closed))
+        Q_EMIT q->fileClosed(url);
+
+    Q_EMIT q->fileChanged(url, changes);
+}
+
+void DBaseFileWatcherPrivate::deliverCoalescedChanges()
+{
+    const qint64 now = coalescingClock.elapsed();
+    const bool trailing = coalescingDelivery.testFlag(DBaseFileWatcher::TrailingDelivery);
+    QVector<QPair<QUrl, DBaseFileWatcher::ChangeFlags>> due;
+    qint64 nextDeadline = -1;
+
+    for (auto it = pendingChanges.begin(); it != pendingChanges.end();) {
+        if (it->deadline <= now) {
+            if (!it->changes || !trailing) {
+                it = pendingChanges.erase(it);
+                continue;
+            }
+
+            // the file is still changing: at most one delivery per window.
+            due.append({it.key(), it->changes});
+            it->changes = DBaseFileWatcher::NoChange;
+            it->deadline = now + coalescingWindow;
+        }
+
+        if (nextDeadline < 0 || it->deadline < nextDeadline)
+            nextDeadline = it->deadline;
+        ++it;
+    }
+
+    if (nextDeadline >= 0)
+        coalescingTimer->start(int(qMax<qint64>(nextDeadline - now, 0)));
+
+    for (const auto &change : std::as_const(due))
+        deliverChanges(change.first, change.second);
+}
+
+void DBaseFileWatcherPrivate::clearCoalescedChanges()
+{
+    pendingChanges.clear();
+    if (coalescingTimer)
+        coalescingTimer->stop();
+}
+
 /*!
 @~english
     @class Dtk::Core::DBaseFileWatcher
@@ -28,6 +142,7 @@ DBaseFileWatcherPrivate::DBaseFileWatcherPrivate(DBaseFileWatcher *qq)
 DBaseFileWatcher::~DBaseFileWatcher()
 {
     stopWatcher();
+    QMutexLocker locker(&DBaseFileWatcherPrivate::watcherListMutex);
     DBaseFileWatcherPrivate::watcherList.removeOne(this);
 }
 
@@ -73,6 +188,7 @@ bool DBaseFileWatcher::stopWatcher()
 
     if (d->stop()) {
         d->started = false;
+        d->clearCoalescedChanges();
 
         return true;
     }
@@ -103,6 +219,78 @@ void DBaseFileWatcher::setEnabledSubfileWatcher(const QUrl &subfileUrl, bool ena
     Q_UNUSED(enabled)
 }
 
+/*!
+@~english
+  @brief Merge the changes of a file which happen within \a msec milliseconds.
+
+  A write storm on a file emits fileModified() for every write. With a coalescing
+  window, the changes of a file are merged and reported at most once per window by
+  fileChanged() with all the changes, and by fileModified(), fileAttributeChanged()
+  and fileClosed() once each. The window of a file begins with its first change.
+
+  @param[in] msec The length of the window, 0 reports every change immediately.
+  @param[in] delivery LeadingDelivery reports the first change of a burst immediately,
+  TrailingDelivery reports the merged changes at the end of the window, and keeps
+  reporting them once per window while the file is changing.
+  Moving or deleting a file reports its pending changes immediately, before fileMoved()
+  or fileDeleted().
+  @sa coalescingWindow(), coalescingDelivery(), fileChanged()
+ */
+void DBaseFileWatcher::setCoalescingWindow(int msec, DeliveryFlags delivery)
+{
+    Q_D(DBaseFileWatcher);
+
+    // the pending changes belong to the old window.
+    const auto pendingChanges = d->pendingChanges;
+    const bool trailing = d->coalescingDelivery.testFlag(TrailingDelivery);
+    d->clearCoalescedChanges();
+
+    d->coalescingWindow = qMax(msec, 0);
+    d->coalescingDelivery = delivery ? delivery : DeliveryFlags(TrailingDelivery);
+
+    if (d->coalescingWindow > 0 && !d->coalescingTimer) {
+        d->coalescingTimer = new QTimer(this);
+        d->coalescingTimer->setSingleShot(true);
+        d->coalescingTimer->setTimerType(Qt::PreciseTimer);
+        connect(d->coalescingTimer, &QTimer::timeout, this, [d] {
+            d->deliverCoalescedChanges();
+        });
+        d->coalescingClock.start();
+    }
+
+    if (!trailing)
+        return;
+
+    for (auto it = pendingChanges.cbegin(); it != pendingChanges.cend(); ++it) {
+        if (it->changes)
+            d->deliverChanges(it.key(), it->changes);
+    }
+}
+
+/*!
+@~english
+  @brief The length of the coalescing window in milliseconds, 0 by default.
+  @sa setCoalescingWindow()
+ */
+int DBaseFileWatcher::coalescingWindow() const
+{
+    Q_D(const DBaseFileWatcher);
+
+    return d->coalescingWindow;
+}
+
+/*!
+@~english
+  @brief When the changes of a coalescing window are reported, TrailingDelivery by default.
+  @sa setCoalescingWindow()
+ */
+DBaseFileWatcher::DeliveryFlags DBaseFileWatcher::coalescingDelivery() const
+{
+    Q_D(const DBaseFileWatcher);
+
+    return d->coalescingDelivery;
+}
+
 /*!
 @~english
   @brief Emit a signal about \a targetUrl got a \a signal with \a arg1
@@ -121,11 +309,9 @@ bool DBaseFileWatcher::ghostSignal(const QUrl &targetUrl, DBaseFileWatcher::Sign
 
     bool ok = false;
 
-    for (DBaseFileWatcher *watcher : DBaseFileWatcherPrivate::watcherList) {
-        if (watcher->fileUrl() == targetUrl) {
-            ok = true;
-            (watcher->*signal)(arg1);
-        }
+    for (DBaseFileWatcher *watcher : DBaseFileWatcherPrivate::watchersOf(targetUrl)) {
+        ok = true;
+        (watcher->*signal)(arg1);
     }
 
     return ok;
@@ -146,11 +332,9 @@ bool DBaseFileWatcher::ghostSignal(const QUrl &targetUrl, DBaseFileWatcher::Sign
 
     bool ok = false;
 
-    for (DBaseFileWatcher *watcher : DBaseFileWatcherPrivate::watcherList) {
-        if (watcher->fileUrl() == targetUrl) {
-            ok = true;
-            (watcher->*signal)(arg1, arg2);
-        }
+    for (DBaseFileWatcher *watcher : DBaseFileWatcherPrivate::watchersOf(targetUrl)) {
+        ok = true;
+        (watcher->*signal)(arg1, arg2);
     }
 
     return ok;
@@ -164,6 +348,7 @@ DBaseFileWatcher::DBaseFileWatcher(DBaseFileWatcherPrivate &dd,
     Q_ASSERT(url.isValid());
 
     d_func()->url = url;
+    QMutexLocker locker(&DBaseFileWatcherPrivate::watcherListMutex);
     DBaseFileWatcherPrivate::watcherList << this;
 }
 
@@ -10,14 +10,604 @@
 #include <QSocketNotifier>
 #include <QDebug>
 #include <QMultiMap>
+#include <QRunnable>
 
 #include <sys/inotify.h>
+#include <sys/eventfd.h>
 #include <sys/fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <poll.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
 DCORE_BEGIN_NAMESPACE
 
+static constexpr quint32 DirectoryWatchMask = 0
+        | IN_ATTRIB
+        | IN_MOVE
+        | IN_MOVE_SELF
+        | IN_CREATE
+        | IN_DELETE
+        | IN_DELETE_SELF
+        | IN_MODIFY;
+
+static constexpr quint32 FileWatchMask = 0
+        | IN_ATTRIB
+        | IN_CLOSE_WRITE
+        | IN_MODIFY
+        | IN_MOVE
+        | IN_MOVE_SELF
+        | IN_DELETE_SELF;
+
+static QString joinFilePath(const QString &path, const QString &name)
+{
+    if (path.endsWith(QDir::separator()))
+        return path + name;
+
+    return path + QDir::separator() + name;
+}
+
+// the kernel events kept while a sweep runs, for the watches it hasn't reported yet.
+static constexpr int MaxPendingEventsSize = 1024 * 1024;
+
+/*
+ * Adds the watches of a directory tree in a background thread and reports
+ * them to the watcher in batches, so that the event loop isn't blocked by a
+ * large tree. The names found in the directories are reported as well when
+ * the tree is new, their creation happened before the watches existed.
+ */
+class DInotifyTreeSweep : public QRunnable
+{
+public:
+    DInotifyTreeSweep(DFileSystemWatcherPrivate *d, DFileSystemWatcher *q, const QString &root, const QString &path, bool replay)
+        : d(d)
+        , q(q)
+        , root(root)
+        , path(path)
+        , replay(replay)
+    {
+    }
+
+    void run() override;
+
+private:
+    void post(QVector<DInotifySweptDirectory> &directories);
+
+    DFileSystemWatcherPrivate *d;
+    DFileSystemWatcher *q;
+    const QString root;
+    const QString path;
+    const bool replay;
+};
+
+void DInotifyTreeSweep::run()
+{
+    static constexpr int BatchSize = 128;
+
+    QVector<DInotifySweptDirectory> directories;
+    QStringList stack{path};
+    while (!stack.isEmpty() && !d->sweepCancelled.load()) {
+        const QString directory = stack.takeLast();
+
+        DInotifySweptDirectory swept;
+        swept.path = directory;
+        // the root of the sweep is watched already unless it's a new directory.
+        if (directory != root) {
+            if (d->sweepAllowance.fetch_sub(1) > 0) {
+                swept.wd = inotify_add_watch(d->inotifyFd, QFile::encodeName(directory), DirectoryWatchMask);
+                if (swept.wd < 0 && errno != ENOSPC)
+                    continue;
+            }
+            // out of the watch budget, the watcher polls it.
+            swept.polled = swept.wd < 0;
+        }
+
+        // symbolic links aren't followed, they could make a cycle.
+        const QDir dir(directory);
+        const QFileInfoList &entries = dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+        for (const QFileInfo &entry : entries) {
+            if (replay)
+                swept.names << entry.fileName();
+            if (entry.isDir() && !entry.isSymLink())
+                stack << entry.absoluteFilePath();
+        }
+
+        if (swept.wd >= 0 || swept.polled)
+            directories << swept;
+        if (directories.size() >= BatchSize)
+            post(directories);
+    }
+
+    post(directories);
+    QMetaObject::invokeMethod(q, [d = d] { d->finishSweep(); }, Qt::QueuedConnection);
+}
+
+void DInotifyTreeSweep::post(QVector<DInotifySweptDirectory> &directories)
+{
+    if (directories.isEmpty())
+        return;
+
+    QMetaObject::invokeMethod(q, [d = d, root = root, directories] {
+        d->addSweptDirectories(root, directories);
+    }, Qt::QueuedConnection);
+    directories.clear();
+}
+
+// the time between two rescans of the watched directories after an overflow.
+static constexpr int RescanInterval = 1000;
+
+// a path out of watches is polled between these intervals, longer while it doesn't change.
+static constexpr int MinPollInterval = 500;
+static constexpr int MaxPollInterval = 8000;
+static constexpr int MaxPollsPerTick = 64;
+
+static int readMaxUserWatches()
+{
+    QFile file(QStringLiteral("/proc/sys/fs/inotify/max_user_watches"));
+    if (!file.open(QIODevice::ReadOnly))
+        return std::numeric_limits<int>::max();
+
+    bool ok = false;
+    const int count = file.readAll().trimmed().toInt(&ok);
+    return ok && count > 0 ? count : std::numeric_limits<int>::max();
+}
+
+static void readStat(const struct stat &st, DInotifySnapshotEntry *entry)
+{
+    entry->inode = st.st_ino;
+    entry->mtime = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    entry->ctime = qint64(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+    entry->size = st.st_size;
+    entry->isDirectory = S_ISDIR(st.st_mode);
+}
+
+static bool statPath(const QString &path, DInotifySnapshotEntry *entry)
+{
+    struct stat st;
+    if (stat(QFile::encodeName(path), &st) != 0) {
+        *entry = DInotifySnapshotEntry();
+        return false;
+    }
+
+    readStat(st, entry);
+    return true;
+}
+
+static DInotifySnapshot scanDirectory(const QString &path, bool *ok)
+{
+    DInotifySnapshot snapshot;
+    DIR *dir = opendir(QFile::encodeName(path));
+    *ok = dir != nullptr;
+    if (!dir)
+        return snapshot;
+
+    const int fd = dirfd(dir);
+    while (const dirent *entry = readdir(dir)) {
+        if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+            continue;
+
+        struct stat st;
+        if (fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            continue;
+
+        readStat(st, &snapshot[QFile::decodeName(entry->d_name)]);
+    }
+    closedir(dir);
+    return snapshot;
+}
+
+void DInotifySnapshotChanges::diff(const QString &path, const DInotifySnapshot &before, const DInotifySnapshot &after)
+{
+    for (auto entry = before.cbegin(); entry != before.cend(); ++entry) {
+        const auto found = after.constFind(entry.key());
+        // another file of the same name replaced it.
+        if (found == after.cend() || (entry->inode && entry->inode != found->inode))
+            deleted.append({path, entry.key(), entry.value()});
+    }
+    for (auto entry = after.cbegin(); entry != after.cend(); ++entry) {
+        const auto found = before.constFind(entry.key());
+        if (found == before.cend() || (found->inode && found->inode != entry->inode))
+            created.append({path, entry.key(), entry.value()});
+        else if (found->mtime >= 0 && (found->mtime != entry->mtime || found->size != entry->size))
+            modified.append({path, entry.key(), entry.value()});
+        else if (found->ctime >= 0 && found->ctime != entry->ctime)
+            attributeChanged.append({path, entry.key(), entry.value()});
+    }
+}
+
+bool DInotifySnapshotChanges::isEmpty() const
+{
+    return deleted.isEmpty() && created.isEmpty() && modified.isEmpty() && attributeChanged.isEmpty();
+}
+
+/*
+ * Takes the snapshots of directories in a background thread, to be diffed
+ * with the earlier ones if report is true.
+ */
+class DInotifyRescan : public QRunnable
+{
+public:
+    DInotifyRescan(DFileSystemWatcherPrivate *d, DFileSystemWatcher *q, const QStringList &directories, bool report)
+        : d(d)
+        , q(q)
+        , directories(directories)
+        , report(report)
+    {
+    }
+
+    void run() override
+    {
+        QHash<QString, DInotifySnapshot> snapshots;
+        for (const QString &directory : directories) {
+            if (d->sweepCancelled.load())
+                return;
+
+            bool ok = false;
+            const DInotifySnapshot &snapshot = scanDirectory(directory, &ok);
+            if (ok)
+                snapshots.insert(directory, snapshot);
+        }
+
+        QMetaObject::invokeMethod(q, [d = d, snapshots, report = report] {
+            d->finishRescan(snapshots, report);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    DFileSystemWatcherPrivate *d;
+    DFileSystemWatcher *q;
+    const QStringList directories;
+    const bool report;
+};
+
+/*
+ * Scans the entries of a polled directory in a background thread, the
+ * watcher thread only stats the directory itself.
+ */
+class DInotifyPollScan : public QRunnable
+{
+public:
+    DInotifyPollScan(DFileSystemWatcherPrivate *d, DFileSystemWatcher *q, const QString &path, quint64 scan)
+        : d(d)
+        , q(q)
+        , path(path)
+        , scan(scan)
+    {
+    }
+
+    void run() override
+    {
+        if (d->sweepCancelled.load())
+            return;
+
+        bool ok = false;
+        const DInotifySnapshot &entries = scanDirectory(path, &ok);
+        QMetaObject::invokeMethod(q, [d = d, path = path, scan = scan, entries, ok] {
+            d->finishPollScan(path, scan, entries, ok);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    DFileSystemWatcherPrivate *d;
+    DFileSystemWatcher *q;
+    const QString path;
+    const quint64 scan;
+};
+
+// the reads kept for the thread of the watcher, it's reading again when they are taken.
+static constexpr qint64 MaxReaderQueueSize = 64 * 1024 * 1024;
+
+DInotifyReader::DInotifyReader(int fd, std::function<void()> wake)
+    : m_fd(fd)
+    , m_wake(std::move(wake))
+{
+    m_stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stopFd < 0) {
+        qWarning() << Q_FUNC_INFO << "eventfd failed" << strerror(errno);
+        return;
+    }
+
+    m_thread = std::thread([this] { run(); });
+}
+
+DInotifyReader::~DInotifyReader()
+{
+    stop();
+    if (m_stopFd >= 0)
+        ::close(m_stopFd);
+
+    // the reads which weren't taken.
+    Chunk *chunk = m_head.exchange(nullptr);
+    while (chunk) {
+        Chunk *next = chunk->next;
+        delete chunk;
+        chunk = next;
+    }
+}
+
+bool DInotifyReader::isRunning() const
+{
+    return m_thread.joinable();
+}
+
+void DInotifyReader::stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    const quint64 stop = 1;
+    if (::write(m_stopFd, &stop, sizeof(stop)) < 0)
+        qWarning() << Q_FUNC_INFO << "can't stop the inotify reader" << strerror(errno);
+    m_thread.join();
+}
+
+void DInotifyReader::run()
+{
+    pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_stopFd, POLLIN, 0}};
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            qWarning() << Q_FUNC_INFO << "poll failed" << strerror(errno);
+            break;
+        }
+        if (fds[1].revents)
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        // the kernel queue holds the events until the watcher catches up.
+        if (m_queuedSize.load(std::memory_order_relaxed) > MaxReaderQueueSize) {
+            if (poll(&fds[1], 1, 10) > 0)
+                break;
+            continue;
+        }
+
+        int size = 0;
+        ioctl(m_fd, FIONREAD, (char *) &size);
+        QByteArray data(qMax<int>(size, sizeof(inotify_event) + NAME_MAX + 1), Qt::Uninitialized);
+        const ssize_t readSize = ::read(m_fd, data.data(), size_t(data.size()));
+        if (readSize <= 0)
+            continue;
+
+        data.resize(int(readSize));
+        push(std::move(data));
+    }
+}
+
+void DInotifyReader::push(QByteArray &&data)
+{
+    m_queuedSize.fetch_add(data.size(), std::memory_order_relaxed);
+
+    Chunk *chunk = new Chunk;
+    chunk->data = std::move(data);
+    chunk->next = m_head.load(std::memory_order_relaxed);
+    while (!m_head.compare_exchange_weak(chunk->next, chunk, std::memory_order_release, std::memory_order_relaxed)) { }
+
+    // a single wake-up for all the reads until the next take().
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel))
+        m_wake();
+}
+
+QByteArray DInotifyReader::take()
+{
+    // a read pushed from now on wakes the watcher again.
+    m_wakePending.store(false, std::memory_order_release);
+    Chunk *chunk = m_head.exchange(nullptr, std::memory_order_acquire);
+
+    // the stack is the latest read first.
+    Chunk *reversed = nullptr;
+    int size = 0;
+    while (chunk) {
+        Chunk *next = chunk->next;
+        chunk->next = reversed;
+        reversed = chunk;
+        size += chunk->data.size();
+        chunk = next;
+    }
+
+    QByteArray data;
+    data.reserve(size);
+    while (reversed) {
+        Chunk *next = reversed->next;
+        data.append(reversed->data);
+        delete reversed;
+        reversed = next;
+    }
+
+    m_queuedSize.fetch_sub(size, std::memory_order_relaxed);
+    return data;
+}
+
+const DInotifyWatchTable::Watch *DInotifyWatchTable::find(int wd) const
+{
+    if (wd <= 0 || m_slots.isEmpty())
+        return nullptr;
+
+    const Watch &watch = m_slots.at(indexOf(wd));
+    return watch.wd ? &watch : nullptr;
+}
+
+DInotifyWatchTable::Paths DInotifyWatchTable::paths(int wd) const
+{
+    Paths paths;
+    const Watch *watch = find(wd);
+    if (!watch)
+        return paths;
+
+    paths.append(watch->path);
+    if (Q_UNLIKELY(!m_morePaths.isEmpty())) {
+        // values() is the latest first.
+        const QList<QString> &more = m_morePaths.values(wd);
+        for (auto path = more.crbegin(); path != more.crend(); ++path)
+            paths.append(*path);
+    }
+    return paths;
+}
+
+int DInotifyWatchTable::pathCount(int wd) const
+{
+    return find(wd) ? 1 + int(m_morePaths.count(wd)) : 0;
+}
+
+int DInotifyWatchTable::indexOf(int wd) const
+{
+    const int mask = m_slots.size() - 1;
+    int index = wd & mask;
+    while (m_slots.at(index).wd && m_slots.at(index).wd != wd)
+        index = (index + 1) & mask;
+    return index;
+}
+
+void DInotifyWatchTable::rehash(int capacity)
+{
+    QVector<Watch> slots(capacity);
+    slots.swap(m_slots);
+    for (Watch &watch : slots) {
+        if (watch.wd)
+            m_slots[indexOf(watch.wd)] = std::move(watch);
+    }
+}
+
+void DInotifyWatchTable::insert(int wd, bool isDirectory, const QString &path)
+{
+    Q_ASSERT(wd > 0);
+
+    // at most three quarters full, the descriptors are mostly consecutive.
+    if ((m_size + 1) * 4 > m_slots.size() * 3)
+        rehash(qMax(16, m_slots.size() * 2));
+
+    Watch &watch = m_slots[indexOf(wd)];
+    if (watch.wd) {
+        m_morePaths.insert(wd, path);
+        return;
+    }
+
+    watch.wd = wd;
+    watch.isDirectory = isDirectory;
+    watch.path = path;
+    ++m_size;
+}
+
+bool DInotifyWatchTable::remove(int wd, const QString &path)
+{
+    if (!find(wd))
+        return false;
+
+    int index = indexOf(wd);
+    if (m_slots.at(index).path != path) {
+        for (auto it = m_morePaths.find(wd); it != m_morePaths.end() && it.key() == wd; ++it) {
+            if (it.value() == path) {
+                m_morePaths.erase(it);
+                break;
+            }
+        }
+        return false;
+    }
+
+    // the earliest of the other paths takes its place.
+    if (Q_UNLIKELY(m_morePaths.contains(wd))) {
+        const QList<QString> &more = m_morePaths.values(wd);
+        m_slots[index].path = more.last();
+        m_morePaths.remove(wd, more.last());
+        return false;
+    }
+
+    m_slots[index] = Watch();
+    --m_size;
+
+    // moves the following watches of the probe sequence back.
+    const int mask = m_slots.size() - 1;
+    for (int next = (index + 1) & mask; m_slots.at(next).wd; next = (next + 1) & mask) {
+        const int home = m_slots.at(next).wd & mask;
+        // next stays if its home is cyclically in (index, next].
+        if (index <= next ? (index < home && home <= next) : (index < home || home <= next))
+            continue;
+
+        m_slots[index] = std::move(m_slots[next]);
+        m_slots[next] = Watch();
+        index = next;
+    }
+    return true;
+}
+
+DInotifyEventBatch::DInotifyEventBatch(const DInotifyWatchTable &watches)
+    : m_watches(watches)
+{
+}
+
+size_t DInotifyEventBatch::EventHash::operator()(const inotify_event *event) const
+{
+    // the name is padded with zeros up to len.
+    const std::string_view name(event->name, event->len ? strnlen(event->name, event->len) : 0);
+    size_t hash = std::hash<std::string_view>()(name);
+    for (const size_t value : {size_t(event->wd), size_t(event->mask), size_t(event->cookie)})
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+bool DInotifyEventBatch::EventEqual::operator()(const inotify_event *a, const inotify_event *b) const
+{
+    return a->wd == b->wd && a->mask == b->mask && a->cookie == b->cookie && a->len == b->len
+            && (!a->len || !strcmp(a->name, b->name));
+}
+
+DInotifyWatchTable::Paths DInotifyEventBatch::paths(int wd, int *id) const
+{
+    const DInotifyWatchTable::Watch *watch = m_watches.find(wd);
+    if (id)
+        *id = watch && watch->isDirectory ? -wd : wd;
+    return m_watches.paths(wd);
+}
+
+void DInotifyEventBatch::parse(const char *buffer, qint64 size, QByteArray *unknownEvents)
+{
+    const char *at = buffer;
+    const char * const end = buffer + size;
+
+    m_seen.reserve(size_t(size / sizeof(inotify_event)));
+    while (at < end) {
+        const inotify_event *event = reinterpret_cast<const inotify_event *>(at);
+        at += sizeof(inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            overflowed = true;
+            continue;
+        }
+
+        const DInotifyWatchTable::Watch *watch = m_watches.find(event->wd);
+        if (!watch) {
+            if (unknownEvents && event->wd >= 0)
+                unknownEvents->append(reinterpret_cast<const char *>(event), int(sizeof(inotify_event) + event->len));
+            continue;
+        }
+
+        if (!(event->mask & IN_MOVED_TO) || !hasMoveFromByCookie.contains(event->cookie)) {
+            if (m_seen.insert(event).second)
+                events.append(event);
+            else
+                ++duplicateCount;
+        }
+
+        if (event->mask & IN_MOVED_TO) {
+            // the latest watched path first.
+            const DInotifyWatchTable::Paths &paths = m_watches.paths(event->wd);
+            for (int i = paths.size() - 1; i >= 0; --i)
+                cookieToFilePath.insert(event->cookie, paths.at(i));
+            cookieToFileName.insert(event->cookie, QString::fromUtf8(event->name));
+        }
+
+        if (event->mask & IN_MOVED_FROM)
+            hasMoveFromByCookie << event->cookie;
+    }
+}
+
 DFileSystemWatcherPrivate::DFileSystemWatcherPrivate(int fd, DFileSystemWatcher *qq)
     : DObjectPrivate(qq)
     , inotifyFd(fd)
@@ -25,10 +615,32 @@ DFileSystemWatcherPrivate::DFileSystemWatcherPrivate(int fd, DFileSystemWatcher
 {
     fcntl(inotifyFd, F_SETFD, FD_CLOEXEC);
     qq->connect(&notifier, SIGNAL(activated(int)), qq, SLOT(_q_readFromInotify()));
+    // one tree after another.
+    sweepPool.setMaxThreadCount(1);
+
+    maxUserWatches = readMaxUserWatches();
+    pollTimer.setSingleShot(true);
+    pollTimer.setTimerType(Qt::CoarseTimer);
+    QObject::connect(&pollTimer, &QTimer::timeout, qq, [this] {
+        pollDuePaths();
+    });
+    pollClock.start();
+
+    rescanTimer.setSingleShot(true);
+    rescanTimer.setInterval(RescanInterval);
+    QObject::connect(&rescanTimer, &QTimer::timeout, qq, [this] {
+        if (rescanRequested)
+            startRescan();
+    });
 }
 
 DFileSystemWatcherPrivate::~DFileSystemWatcherPrivate()
 {
+    // the sweeps and the reader use inotifyFd.
+    reader.reset();
+    sweepCancelled = true;
+    sweepPool.waitForDone();
+
     notifier.setEnabled(false);
     Q_FOREACH (int id, pathToID)
         inotify_rm_watch(inotifyFd, id < 0 ? -id : id);
@@ -36,189 +648,666 @@ DFileSystemWatcherPrivate::~DFileSystemWatcherPrivate()
     ::close(inotifyFd);
 }
 
+int DFileSystemWatcherPrivate::watchBudget() const
+{
+    if (maxWatchCount > 0)
+        return qMin(maxWatchCount, maxUserWatches);
+    return maxUserWatches;
+}
+
+int DFileSystemWatcherPrivate::addWatch(const QString &path, bool isDirectory, bool mayDemote)
+{
+    const QByteArray &encodedPath = QFile::encodeName(path);
+    const quint32 mask = isDirectory ? DirectoryWatchMask : FileWatchMask;
+    int wd = inotify_add_watch(inotifyFd, encodedPath, mask);
+    // a directory takes the watch of a file, a polled file costs less.
+    if (wd < 0 && errno == ENOSPC && isDirectory && mayDemote && demoteFileWatch())
+        wd = inotify_add_watch(inotifyFd, encodedPath, mask);
+    if (wd < 0)
+        return wd;
+
+    // the same inode shares its watch.
+    if (watches.find(wd) || watches.size() < watchBudget())
+        return wd;
+
+    if (isDirectory && mayDemote && demoteFileWatch())
+        return wd;
+
+    inotify_rm_watch(inotifyFd, wd);
+    errno = ENOSPC;
+    return -1;
+}
+
+bool DFileSystemWatcherPrivate::demoteFileWatch()
+{
+    for (auto it = files.crbegin(); it != files.crend(); ++it) {
+        const int id = pathToID.value(*it);
+        if (id <= 0 || watches.pathCount(id) != 1)
+            continue;
+
+        const QString path = *it;
+        pathToID.remove(path);
+        watches.remove(id, path);
+        snapshots.remove(path);
+        inotify_rm_watch(inotifyFd, id);
+        startPolling(path, false);
+        return true;
+    }
+    return false;
+}
+
+void DFileSystemWatcherPrivate::promotePolledPaths()
+{
+    if (polledPaths.isEmpty() || watches.size() >= watchBudget())
+        return;
+
+    // the directories first, their watch covers their entries.
+    QStringList candidates;
+    for (auto it = polledPaths.cbegin(); it != polledPaths.cend(); ++it) {
+        if (it->isDirectory)
+            candidates.prepend(it.key());
+        else
+            candidates.append(it.key());
+    }
+
+    QStringList newDirectories;
+    for (const QString &path : std::as_const(candidates)) {
+        if (watches.size() >= watchBudget())
+            break;
+
+        const bool isDirectory = polledPaths.value(path).isDirectory;
+        const int wd = addWatch(path, isDirectory, false);
+        if (wd < 0)
+            continue;
+
+        pathToID.insert(path, isDirectory ? -wd : wd);
+        watches.insert(wd, isDirectory, path);
+        polledPaths.remove(path);
+        if (isDirectory)
+            newDirectories << path;
+    }
+    snapshotDirectories(newDirectories);
+}
+
+void DFileSystemWatcherPrivate::startPolling(const QString &path, bool isDirectory)
+{
+    if (!pollingWarned) {
+        pollingWarned = true;
+        qWarning() << Q_FUNC_INFO << "out of inotify watches, polling" << path << "and the paths over"
+                   << watchBudget() << "watches, see fs.inotify.max_user_watches";
+    }
+
+    DPolledPath &polled = polledPaths[path];
+    polled.isDirectory = isDirectory;
+    polled.interval = MinPollInterval;
+    statPath(path, &polled.self);
+    polled.entries.clear();
+    polled.scanned = false;
+    polled.scanning = false;
+    polled.scanAgain = false;
+    if (isDirectory)
+        scanPolledDirectory(path, polled);
+    schedulePoll(path, polled);
+}
+
+void DFileSystemWatcherPrivate::schedulePoll(const QString &path, DPolledPath &polled)
+{
+    polled.due = pollClock.elapsed() + polled.interval;
+    pollSchedule.insert(polled.due, path);
+    if (!pollTimer.isActive() || pollTimer.remainingTime() > polled.interval)
+        pollTimer.start(polled.interval);
+}
+
+void DFileSystemWatcherPrivate::pollDuePaths()
+{
+    const qint64 now = pollClock.elapsed();
+    QVector<QPair<qint64, QString>> due;
+    for (auto it = pollSchedule.begin(); it != pollSchedule.end() && it.key() <= now && due.size() < MaxPollsPerTick;) {
+        due.append({it.key(), it.value()});
+        it = pollSchedule.erase(it);
+    }
+
+    for (const auto &path : std::as_const(due))
+        poll(path.second, path.first);
+
+    // the rest of a long schedule on the next tick.
+    if (!pollSchedule.isEmpty())
+        pollTimer.start(int(qBound<qint64>(0, pollSchedule.firstKey() - pollClock.elapsed(), MaxPollInterval)));
+}
+
+void DFileSystemWatcherPrivate::poll(const QString &path, qint64 due)
+{
+    Q_Q(DFileSystemWatcher);
+
+    auto polled = polledPaths.find(path);
+    // removed, or polled again since it was scheduled.
+    if (polled == polledPaths.end() || polled->due != due)
+        return;
+
+    DInotifySnapshotEntry self;
+    const bool exists = statPath(path, &self);
+    const DInotifySnapshotEntry before = polled->self;
+    const bool existed = before.inode;
+    const bool isDirectory = polled->isDirectory;
+    polled->self = self;
+
+    const bool modified = exists && existed && (before.mtime != self.mtime || before.size != self.size);
+    const bool attributeChanged = exists && existed && !modified && before.ctime != self.ctime;
+    const bool changed = existed != exists || modified || attributeChanged;
+    // the entries added, removed or renamed change the time of the directory, the ones
+    // modified in place don't, a quiet directory is scanned at the longest interval.
+    if (isDirectory && exists && (changed || polled->interval == MaxPollInterval))
+        scanPolledDirectory(path, *polled);
+    // a quiet path is polled less often.
+    polled->interval = changed ? MinPollInterval : qMin(polled->interval * 2, MaxPollInterval);
+    schedulePoll(path, *polled);
+
+    // the signals last, their slots may remove the path.
+    if (existed && !exists) {
+        Q_EMIT q->fileDeleted(path, QString(), DFileSystemWatcher::QPrivateSignal());
+    } else if (!existed && exists) {
+        Q_EMIT q->fileCreated(path, QString(), DFileSystemWatcher::QPrivateSignal());
+    } else if (modified && !isDirectory) {
+        // the entries of a directory change its time, they are reported by themselves.
+        Q_EMIT q->fileModified(path, QString(), DFileSystemWatcher::QPrivateSignal());
+    } else if (attributeChanged) {
+        Q_EMIT q->fileAttributeChanged(path, QString(), DFileSystemWatcher::QPrivateSignal());
+    }
+}
+
+void DFileSystemWatcherPrivate::scanPolledDirectory(const QString &path, DPolledPath &polled)
+{
+    Q_Q(DFileSystemWatcher);
+
+    // the scan in flight may have missed the change.
+    if (polled.scanning) {
+        polled.scanAgain = true;
+        return;
+    }
+
+    polled.scanning = true;
+    polled.scan = ++pollScans;
+    sweepPool.start(new DInotifyPollScan(this, q, path, polled.scan));
+}
+
+void DFileSystemWatcherPrivate::finishPollScan(const QString &path, quint64 scan, const DInotifySnapshot &entries, bool ok)
+{
+    auto polled = polledPaths.find(path);
+    // removed, watched again, or polled anew since the scan started.
+    if (polled == polledPaths.end() || polled->scan != scan)
+        return;
+
+    polled->scanning = false;
+    DInotifySnapshotChanges changes;
+    if (!polled->scanned) {
+        // the entries to diff the later scans with.
+        polled->scanned = true;
+        if (ok)
+            polled->entries = entries;
+    } else if (ok) {
+        changes.diff(path, polled->entries, entries);
+        polled->entries = entries;
+    }
+
+    if (polled->scanAgain) {
+        polled->scanAgain = false;
+        scanPolledDirectory(path, *polled);
+    }
+    if (!changes.isEmpty())
+        polled->interval = MinPollInterval;
+
+    emitSnapshotChanges(changes);
+}
+
 QStringList DFileSystemWatcherPrivate::addPaths(const QStringList &paths, QStringList *files, QStringList *directories)
 {
+    QStringList newDirectories;
     QStringList p = paths;
     QMutableListIterator<QString> it(p);
     while (it.hasNext()) {
         QString path = it.next();
         QFileInfo fi(path);
         bool isDir = fi.isDir();
-        if (isDir) {
-            if (directories->contains(path))
-                continue;
-        } else {
-            if (files->contains(path))
-                continue;
-        }
+        // pathToID holds the paths of files and directories, negative ids are directories.
+        auto watched = pathToID.constFind(path);
+        if (watched != pathToID.constEnd() && (watched.value() < 0) == isDir)
+            continue;
+        if (polledPaths.contains(path))
+            continue;
 
-        int wd = inotify_add_watch(inotifyFd,
-                                   QFile::encodeName(path),
-                                   (isDir
-                                    ? (0
-                                       | IN_ATTRIB
-                                       | IN_MOVE
-                                       | IN_MOVE_SELF
-                                       | IN_CREATE
-                                       | IN_DELETE
-                                       | IN_DELETE_SELF
-                                       | IN_MODIFY
-                                       )
-                                    : (0
-                                       | IN_ATTRIB
-                                       | IN_CLOSE_WRITE
-                                       | IN_MODIFY
-                                       | IN_MOVE
-                                       | IN_MOVE_SELF
-                                       | IN_DELETE_SELF
-                                       )));
-        if (wd < 0) {
+        int wd = addWatch(path, isDir, true);
+        if (wd < 0 && errno != ENOSPC) {
             perror("DFileSystemWatcherPrivate::addPaths: inotify_add_watch failed");
             continue;
         }
 
         it.remove();
 
-        int id = isDir ? -wd : wd;
-        if (id < 0) {
+        if (isDir) {
             directories->append(path);
         } else {
             files->append(path);
         }
 
-        pathToID.insert(path, id);
-        idToPath.insert(id, path);
+        // out of watches, the path is polled instead.
+        if (wd < 0) {
+            startPolling(path, isDir);
+            continue;
+        }
+
+        pathToID.insert(path, isDir ? -wd : wd);
+        watches.insert(wd, isDir, path);
+        if (isDir)
+            newDirectories << path;
     }
 
+    snapshotDirectories(newDirectories);
     return p;
 }
 
 QStringList DFileSystemWatcherPrivate::removePaths(const QStringList &paths, QStringList *files, QStringList *directories)
 {
     QStringList p = paths;
+    // the lists are filtered once, a tree can be large.
+    QSet<QString> removedFiles;
+    QSet<QString> removedDirectories;
     QMutableListIterator<QString> it(p);
     while (it.hasNext()) {
         QString path = it.next();
-        int id = pathToID.take(path);
-        for (auto hit = idToPath.find(id); hit != idToPath.end() && hit.key() == id; ++hit) {
-            if (hit.value() == path) {
-                idToPath.erase(hit);
-                break;
-            }
+        if (recursiveRoots.remove(path))
+            removeRecursiveTree(path);
+
+        auto polled = polledPaths.find(path);
+        if (polled != polledPaths.end()) {
+            const bool isDirectory = polled->isDirectory;
+            polledPaths.erase(polled);
+            it.remove();
+            if (isDirectory)
+                removedDirectories.insert(path);
+            else
+                removedFiles.insert(path);
+            continue;
         }
 
+        int id = pathToID.take(path);
+        int wd = id < 0 ? -id : id;
+
         it.remove();
+        snapshots.remove(path);
 
-        if (!idToPath.contains(id)) {
-            int wd = id < 0 ? -id : id;
+        if (watches.remove(wd, path)) {
             //qDebug() << "removing watch for path" << path << "wd" << wd;
             inotify_rm_watch(inotifyFd, wd);
         }
 
         if (id < 0) {
-            directories->removeAll(path);
+            removedDirectories.insert(path);
         } else {
-            files->removeAll(path);
+            removedFiles.insert(path);
         }
     }
 
+    auto removeFrom = [](QStringList *list, const QSet<QString> &removed) {
+        if (removed.isEmpty())
+            return;
+        auto end = std::remove_if(list->begin(), list->end(), [&removed](const QString &path) {
+            return removed.contains(path);
+        });
+        list->erase(end, list->end());
+    };
+    removeFrom(files, removedFiles);
+    removeFrom(directories, removedDirectories);
+
+    promotePolledPaths();
     return p;
 }
 
-void DFileSystemWatcherPrivate::_q_readFromInotify()
+bool DFileSystemWatcherPrivate::addRecursivePath(const QString &path)
+{
+    if (!QFileInfo(path).isDir())
+        return addPaths({path}, &files, &directories).isEmpty();
+
+    if (!pathToID.contains(path) && !polledPaths.contains(path) && !addPaths({path}, &files, &directories).isEmpty())
+        return false;
+
+    if (!recursiveRoots.contains(path)) {
+        recursiveRoots.insert(path);
+        // a subdirectory watched on its own becomes a part of the tree.
+        recursiveDirectories.remove(path);
+        sweep(path, path, false);
+    }
+    return true;
+}
+
+void DFileSystemWatcherPrivate::sweep(const QString &root, const QString &path, bool replay)
 {
     Q_Q(DFileSystemWatcher);
-//    qDebug() << "QInotifyFileSystemWatcherEngine::readFromInotify";
 
-    int buffSize = 0;
-    ioctl(inotifyFd, FIONREAD, (char *) &buffSize);
-    QVarLengthArray<char, 4096> buffer(buffSize);
-    buffSize = read(inotifyFd, buffer.data(), buffSize);
-    char *at = buffer.data();
-    char * const end = at + buffSize;
-
-    QList<inotify_event *> eventList;
-    QMultiHash<int, QString> batch_pathmap;
-    /// only save event: IN_MOVE_TO
-    QMultiMap<int, QString> cookieToFilePath;
-    QMultiMap<int, QString> cookieToFileName;
-    QSet<int> hasMoveFromByCookie;
-#ifdef QT_DEBUG
-    int exist_count = 0;
-#endif
-    while (at < end) {
-        inotify_event *event = reinterpret_cast<inotify_event *>(at);
-        QStringList paths;
+    // the sweeps take their watches from the allowance, it's renewed once they are all done.
+    if (sweepsInProgress == 0)
+        sweepAllowance = qMax(watchBudget() - watches.size(), 0);
+    ++sweepsInProgress;
+    sweepPool.start(new DInotifyTreeSweep(this, q, root, path, replay));
+}
 
-        at += sizeof(inotify_event) + event->len;
+void DFileSystemWatcherPrivate::addSweptDirectories(const QString &root, const QVector<DInotifySweptDirectory> &swept)
+{
+    Q_Q(DFileSystemWatcher);
 
-        int id = event->wd;
-        paths = idToPath.values(id);
-        if (paths.empty()) {
-            // perhaps a directory?
-            id = -id;
-            paths = idToPath.values(id);
-            if (paths.empty())
-                continue;
+    const bool removed = !recursiveRoots.contains(root);
+    QStringList newDirectories;
+    for (const DInotifySweptDirectory &directory : swept) {
+        if (removed || pathToID.contains(directory.path)) {
+            // the same directory has the same watch.
+            if (directory.wd >= 0 && !watches.find(directory.wd))
+                inotify_rm_watch(inotifyFd, directory.wd);
+            continue;
         }
 
-        if (!(event->mask & IN_MOVED_TO) || !hasMoveFromByCookie.contains(event->cookie)) {
-            auto it = std::find_if(eventList.begin(), eventList.end(), [event](inotify_event *e){
-                    return event->wd == e->wd && event->mask == e->mask &&
-                           event->cookie == e->cookie &&
-                           event->len == e->len &&
-                           !strcmp(event->name, e->name);
-            });
-
-            if (it==eventList.end()) {
-                eventList.append(event);
-            }
-#ifdef QT_DEBUG
-            else {
-                qDebug() << "exist event:" << "event->wd" << event->wd <<
-                            "event->mask" << event->mask <<
-                            "event->cookie" << event->cookie << "exist counts " << ++exist_count;
-            }
-#endif
-            const QList<QString> bps = batch_pathmap.values(id);
-            for (auto &path : paths) {
-                if (!bps.contains(path)) {
-                    batch_pathmap.insert(id, path);
-                }
-            }
+        directories.append(directory.path);
+        recursiveDirectories.insert(directory.path, root);
+        // the watches added since the sweep started aren't known to it.
+        const bool overBudget = directory.wd >= 0 && !watches.find(directory.wd) && watches.size() >= watchBudget();
+        if (overBudget)
+            inotify_rm_watch(inotifyFd, directory.wd);
+        if (directory.polled || overBudget) {
+            startPolling(directory.path, true);
+        } else {
+            pathToID.insert(directory.path, -directory.wd);
+            watches.insert(directory.wd, true, directory.path);
+            newDirectories << directory.path;
         }
 
-        if (event->mask & IN_MOVED_TO) {
-            for (auto &path : paths) {
-                cookieToFilePath.insert(event->cookie, path);
-            }
-            cookieToFileName.insert(event->cookie, QString::fromUtf8(event->name));
+        // created before the directory was watched.
+        for (const QString &name : directory.names)
+            Q_EMIT q->fileCreated(directory.path, name, DFileSystemWatcher::QPrivateSignal());
+    }
+    snapshotDirectories(newDirectories);
+
+    // the events which happened since the watches were added.
+    if (!pendingEvents.isEmpty()) {
+        QByteArray events;
+        events.swap(pendingEvents);
+        processEvents(events.constData(), events.size());
+    }
+}
+
+void DFileSystemWatcherPrivate::finishSweep()
+{
+    if (--sweepsInProgress > 0)
+        return;
+
+    // the watches are known now, the rest isn't ours.
+    pendingEvents.clear();
+}
+
+void DFileSystemWatcherPrivate::removeRecursiveTree(const QString &path)
+{
+    if (recursiveDirectories.isEmpty())
+        return;
+
+    // the map is ordered, the directories below the path follow each other.
+    const QString &prefix = path.endsWith(QDir::separator()) ? path : path + QDir::separator();
+    QStringList tree;
+    if (recursiveDirectories.remove(path))
+        tree << path;
+    auto it = recursiveDirectories.lowerBound(prefix);
+    while (it != recursiveDirectories.end() && it.key().startsWith(prefix)) {
+        tree << it.key();
+        it = recursiveDirectories.erase(it);
+    }
+
+    if (!tree.isEmpty())
+        removePaths(tree, &files, &directories);
+}
+
+QString DFileSystemWatcherPrivate::recursiveRootOf(const QString &path) const
+{
+    if (recursiveRoots.contains(path))
+        return path;
+    return recursiveDirectories.value(path);
+}
+
+void DFileSystemWatcherPrivate::setReaderThreadEnabled(bool enabled)
+{
+    Q_Q(DFileSystemWatcher);
+
+    if (enabled == bool(reader))
+        return;
+
+    if (enabled) {
+        notifier.setEnabled(false);
+        reader.reset(new DInotifyReader(inotifyFd, [this, q] {
+            QMetaObject::invokeMethod(q, [this] { readFromReader(); }, Qt::QueuedConnection);
+        }));
+        if (reader->isRunning())
+            return;
+
+        reader.reset();
+        notifier.setEnabled(true);
+        return;
+    }
+
+    // the events read already come before the ones the notifier reads.
+    reader->stop();
+    const QByteArray &events = reader->take();
+    reader.reset();
+    notifier.setEnabled(true);
+    if (!events.isEmpty())
+        processEvents(events.constData(), events.size());
+}
+
+void DFileSystemWatcherPrivate::setOverflowRecoveryEnabled(bool enabled)
+{
+    if (enabled == overflowRecovery)
+        return;
+
+    overflowRecovery = enabled;
+    if (enabled) {
+        snapshotDirectories(directories);
+        return;
+    }
+
+    snapshots.clear();
+    rescanRequested = false;
+    rescanTimer.stop();
+}
+
+void DFileSystemWatcherPrivate::snapshotDirectories(const QStringList &paths)
+{
+    Q_Q(DFileSystemWatcher);
+
+    if (!overflowRecovery || paths.isEmpty())
+        return;
+
+    sweepPool.start(new DInotifyRescan(this, q, paths, false));
+}
+
+void DFileSystemWatcherPrivate::requestRescan()
+{
+    rescanRequested = true;
+    if (rescanInProgress || rescanTimer.isActive())
+        return;
+
+    startRescan();
+}
+
+void DFileSystemWatcherPrivate::startRescan()
+{
+    Q_Q(DFileSystemWatcher);
+
+    rescanRequested = false;
+    if (snapshots.isEmpty())
+        return;
+
+    rescanInProgress = true;
+    sweepPool.start(new DInotifyRescan(this, q, snapshots.keys(), true));
+}
+
+void DFileSystemWatcherPrivate::finishRescan(const QHash<QString, DInotifySnapshot> &scanned, bool report)
+{
+    if (report) {
+        rescanInProgress = false;
+        rescanTimer.start();
+    }
+    if (!overflowRecovery)
+        return;
+
+    DInotifySnapshotChanges changes;
+    for (auto it = scanned.cbegin(); it != scanned.cend(); ++it) {
+        const QString &path = it.key();
+        auto snapshot = snapshots.find(path);
+        if (!report) {
+            // the directory may be gone from the watcher meanwhile.
+            if (pathToID.value(path) < 0)
+                snapshots.insert(path, it.value());
+            continue;
         }
+        if (snapshot == snapshots.end())
+            continue;
 
-        if (event->mask & IN_MOVED_FROM)
-            hasMoveFromByCookie << event->cookie;
+        changes.diff(path, snapshot.value(), it.value());
+        *snapshot = it.value();
     }
 
-//    qDebug() << "event count:" << eventList.count();
+    emitSnapshotChanges(changes);
+}
 
-    QList<inotify_event *>::const_iterator it = eventList.constBegin();
-    while (it != eventList.constEnd()) {
-        const inotify_event &event = **it;
-        ++it;
+void DFileSystemWatcherPrivate::emitSnapshotChanges(const DInotifySnapshotChanges &changes)
+{
+    Q_Q(DFileSystemWatcher);
 
-//        qDebug() << "inotify event, wd" << event.wd << "cookie" << event.cookie << "mask" << hex << event.mask;
+    const QVector<DInotifySnapshotChanges::Change> &deleted = changes.deleted;
+    const QVector<DInotifySnapshotChanges::Change> &created = changes.created;
+    if (changes.isEmpty())
+        return;
 
-        int id = event.wd;
-        QStringList paths = batch_pathmap.values(id);
+    // an entry deleted and created with the same inode was moved.
+    QHash<quint64, int> createdByInode;
+    for (int i = 0; i < created.size(); ++i) {
+        if (created.at(i).entry.inode)
+            createdByInode.insert(created.at(i).entry.inode, i);
+    }
+    QVector<bool> moved(created.size(), false);
+    for (const auto &from : deleted) {
+        const int i = from.entry.inode ? createdByInode.value(from.entry.inode, -1) : -1;
+        if (i < 0 || moved.at(i)) {
+            Q_EMIT q->fileDeleted(from.path, from.name, DFileSystemWatcher::QPrivateSignal());
+            if (from.entry.isDirectory)
+                removeRecursiveTree(joinFilePath(from.path, from.name));
+            continue;
+        }
 
-        if (paths.empty()) {
-            id = -id;
-            paths = batch_pathmap.values(id);
+        moved[i] = true;
+        const auto &to = created.at(i);
+        Q_EMIT q->fileMoved(from.path, from.name, to.path, to.name, DFileSystemWatcher::QPrivateSignal());
+        if (from.entry.isDirectory) {
+            removeRecursiveTree(joinFilePath(from.path, from.name));
+            const QString &root = recursiveRootOf(to.path);
+            if (!root.isEmpty())
+                sweep(root, joinFilePath(to.path, to.name), false);
+        }
+    }
+    for (int i = 0; i < created.size(); ++i) {
+        if (moved.at(i))
+            continue;
 
-            if (paths.empty())
-                continue;
+        const auto &change = created.at(i);
+        Q_EMIT q->fileCreated(change.path, change.name, DFileSystemWatcher::QPrivateSignal());
+        const QString &root = change.entry.isDirectory ? recursiveRootOf(change.path) : QString();
+        if (!root.isEmpty())
+            sweep(root, joinFilePath(change.path, change.name), true);
+    }
+    for (const auto &change : changes.modified)
+        Q_EMIT q->fileModified(change.path, change.name, DFileSystemWatcher::QPrivateSignal());
+    for (const auto &change : changes.attributeChanged)
+        Q_EMIT q->fileAttributeChanged(change.path, change.name, DFileSystemWatcher::QPrivateSignal());
+}
+
+void DFileSystemWatcherPrivate::updateSnapshot(const QString &path, const QString &name, quint32 mask)
+{
+    auto snapshot = snapshots.find(path);
+    if (snapshot == snapshots.end())
+        return;
+
+    if (mask & (IN_DELETE | IN_MOVED_FROM)) {
+        snapshot->remove(name);
+    } else if (mask & (IN_CREATE | IN_MOVED_TO)) {
+        DInotifySnapshotEntry entry;
+        entry.isDirectory = mask & IN_ISDIR;
+        snapshot->insert(name, entry);
+    } else if (mask & (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE)) {
+        // reported already, a rescan doesn't report it again.
+        auto entry = snapshot->find(name);
+        if (entry != snapshot->end()) {
+            entry->mtime = -1;
+            entry->size = -1;
+            entry->ctime = -1;
         }
-        const QString &name = QString::fromUtf8(event.name);
+    }
+}
+
+void DFileSystemWatcherPrivate::readFromReader()
+{
+    // a wake-up of a reader which is gone.
+    if (!reader)
+        return;
+
+    const QByteArray &events = reader->take();
+    if (!events.isEmpty())
+        processEvents(events.constData(), events.size());
+}
+
+void DFileSystemWatcherPrivate::_q_readFromInotify()
+{
+//    qDebug() << "QInotifyFileSystemWatcherEngine::readFromInotify";
+
+    int buffSize = 0;
+    ioctl(inotifyFd, FIONREAD, (char *) &buffSize);
+    QVarLengthArray<char, 4096> buffer(buffSize);
+    buffSize = read(inotifyFd, buffer.data(), buffSize);
+    if (buffSize <= 0)
+        return;
+
+    processEvents(buffer.constData(), buffSize);
+}
+
+void DFileSystemWatcherPrivate::processEvents(const char *buffer, qint64 size)
+{
+    Q_Q(DFileSystemWatcher);
+
+    DInotifyEventBatch batch(watches);
+    // the watches of a running sweep may have events before the sweep reports them.
+    batch.parse(buffer, size, sweepsInProgress > 0 ? &pendingEvents : nullptr);
+    if (pendingEvents.size() > MaxPendingEventsSize) {
+        qWarning() << Q_FUNC_INFO << "too many events of the directories being watched, dropped" << pendingEvents.size() << "bytes";
+        pendingEvents.clear();
+    }
+    const QMultiMap<int, QString> &cookieToFilePath = batch.cookieToFilePath;
+    const QMultiMap<int, QString> &cookieToFileName = batch.cookieToFileName;
+    const QSet<int> &hasMoveFromByCookie = batch.hasMoveFromByCookie;
+    if (batch.overflowed) {
+        if (overflowRecovery)
+            requestRescan();
+        else
+            qWarning() << Q_FUNC_INFO << "the inotify queue overflowed, events are lost";
+    }
+#ifdef QT_DEBUG
+    if (batch.duplicateCount > 0)
+        qDebug() << "exist event counts" << batch.duplicateCount;
+#endif
+
+//    qDebug() << "event count:" << batch.events.count();
+
+    for (const inotify_event *e : std::as_const(batch.events)) {
+        const inotify_event &event = *e;
+
+//        qDebug() << "inotify event, wd" << event.wd << "cookie" << event.cookie << "mask" << hex << event.mask;
+
+        int id = 0;
+        // a copy, the watches may change while they are reported.
+        const DInotifyWatchTable::Paths paths = batch.paths(event.wd, &id);
+        const QString &name = event.len ? QString::fromUtf8(event.name) : QString();
 
         for (auto &path : paths) {
 //            qDebug() << "event for path" << path;
@@ -343,6 +1432,32 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
 
                 Q_EMIT q->fileModified(path, name, DFileSystemWatcher::QPrivateSignal());
             }
+
+            if (id < 0 && !name.isEmpty() && !snapshots.isEmpty())
+                updateSnapshot(path, name, event.mask);
+
+            // keeps the watches of a recursive tree in step with its directories.
+            if (id < 0 && (event.mask & IN_ISDIR) && !name.isEmpty()) {
+                const QString &root = recursiveRootOf(path);
+                if (event.mask & (IN_DELETE | IN_MOVED_FROM))
+                    removeRecursiveTree(filePath);
+                if (!root.isEmpty() && (event.mask & IN_CREATE))
+                    sweep(root, filePath, true);
+                // a move inside the read is reported by IN_MOVED_FROM only.
+                if (!root.isEmpty() && (event.mask & IN_MOVED_TO))
+                    sweep(root, filePath, false);
+                if (event.mask & IN_MOVED_FROM) {
+                    const QString &toName = cookieToFileName.value(event.cookie);
+                    for (const QString &toPath : cookieToFilePath.values(event.cookie)) {
+                        const QString &toRoot = recursiveRootOf(toPath);
+                        if (!toRoot.isEmpty())
+                            sweep(toRoot, joinFilePath(toPath, toName), false);
+                    }
+                }
+            }
+
+            if ((event.mask & IN_IGNORED) && recursiveDirectories.contains(path))
+                removeRecursiveTree(path);
         }
     }
 }
@@ -350,7 +1465,8 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
 void DFileSystemWatcherPrivate::onFileChanged(const QString &path, bool removed)
 {
     Q_Q(DFileSystemWatcher);
-    if (!files.contains(path)) {
+    auto watched = pathToID.constFind(path);
+    if (watched == pathToID.constEnd() || watched.value() < 0) {
         // the path was removed after a change was detected, but before we delivered the signal
         return;
     }
@@ -363,7 +1479,8 @@ void DFileSystemWatcherPrivate::onFileChanged(const QString &path, bool removed)
 void DFileSystemWatcherPrivate::onDirectoryChanged(const QString &path, bool removed)
 {
     Q_Q(DFileSystemWatcher);
-    if (!directories.contains(path)) {
+    auto watched = pathToID.constFind(path);
+    if (watched == pathToID.constEnd() || watched.value() >= 0) {
         // perhaps the path was removed after a change was detected, but before we delivered the signal
         return;
     }
@@ -529,6 +1646,180 @@ QStringList DFileSystemWatcher::addPaths(const QStringList &paths)
     return p;
 }
 
+/*!
+    Adds the directory \a path and every directory below it to the file
+    system watcher, the events of the whole tree are reported like the events
+    of a watched directory. A \a path which isn't a directory is added like
+    addPath() does.
+
+    The watches of the subdirectories are added in a background thread, the
+    events which happen meanwhile are reported once their watch is known.
+    A directory created in the tree later is watched as well, the files
+    created in it before its watch existed are reported by fileCreated(),
+    so a file may be reported twice. A directory removed or moved out of the
+    tree isn't watched anymore, removePath() removes the whole tree.
+
+    Returns true if \a path is watched.
+
+    \sa addPath(), removePath()
+*/
+bool DFileSystemWatcher::addRecursivePath(const QString &path)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return false;
+
+    if (path.isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "the path is empty and it is not be watched";
+        return false;
+    }
+
+    return d->addRecursivePath(path);
+}
+
+/*!
+    Reads the inotify events in a thread of its own if \a enabled is true,
+    instead of the thread of the watcher.
+
+    The thread only reads the events and hands them over to the thread of
+    the watcher, which handles all the events read since it handled the last
+    ones at once. The kernel queue is drained while the thread of the
+    watcher is busy, so that its events aren't lost by an overflow of the
+    queue, which is limited by fs.inotify.max_queued_events. The signals
+    are still emitted in the thread of the watcher.
+
+    \sa isReaderThreadEnabled()
+*/
+void DFileSystemWatcher::setReaderThreadEnabled(bool enabled)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return;
+
+    d->setReaderThreadEnabled(enabled);
+}
+
+/*!
+    Returns true if the inotify events are read in a thread of their own.
+
+    \sa setReaderThreadEnabled()
+*/
+bool DFileSystemWatcher::isReaderThreadEnabled() const
+{
+    Q_D(const DFileSystemWatcher);
+
+    return d && d->reader;
+}
+
+/*!
+    Keeps a snapshot of every watched directory if \a enabled is true, to
+    recover from an overflow of the kernel queue.
+
+    When the queue overflows, the events which didn't fit are lost. The
+    directories are scanned again in a background thread and compared with
+    their snapshots, the differences are reported as fileCreated(),
+    fileDeleted(), fileMoved(), fileModified() and fileAttributeChanged(),
+    a file moved between two
+    watched directories is recognized by its inode. Only the entries of the
+    directories are compared, the events of watched files are still lost.
+    The directories are scanned once per second at most.
+
+    A snapshot holds the name, inode, modification time and size of the
+    entries of a directory, it's kept up to date by the events.
+
+    \sa isOverflowRecoveryEnabled(), setReaderThreadEnabled()
+*/
+void DFileSystemWatcher::setOverflowRecoveryEnabled(bool enabled)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return;
+
+    d->setOverflowRecoveryEnabled(enabled);
+}
+
+/*!
+    Returns true if the watched directories are scanned again after an
+    overflow of the kernel queue.
+
+    \sa setOverflowRecoveryEnabled()
+*/
+bool DFileSystemWatcher::isOverflowRecoveryEnabled() const
+{
+    Q_D(const DFileSystemWatcher);
+
+    return d && d->overflowRecovery;
+}
+
+/*!
+    Limits the inotify watches of the watcher to \a count, a count of 0
+    or less lifts the limit. The watches are limited by
+    fs.inotify.max_user_watches anyway.
+
+    A path which can't be watched because the watches are used up is polled
+    instead: it's reported by files() or directories() like the watched paths,
+    and its changes are found by comparing its status from time to time. The
+    entries of a polled directory are compared in a background thread when its
+    status changes, and at the longest interval. A path is polled every 0.5
+    seconds after a change, and less often up to every 8 seconds while it
+    doesn't change. The directories are preferred to the files, a directory
+    takes the watch of a file if there is no watch left for it. The polled
+    paths are watched again when watches are freed by removePaths(). Lowering
+    the limit keeps the watches in use.
+
+    \sa watchBudget(), watchCount(), polledPaths()
+*/
+void DFileSystemWatcher::setWatchBudget(int count)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return;
+
+    d->maxWatchCount = qMax(count, 0);
+    d->promotePolledPaths();
+}
+
+/*!
+    Returns the maximum number of inotify watches the watcher uses.
+
+    \sa setWatchBudget(), watchCount()
+*/
+int DFileSystemWatcher::watchBudget() const
+{
+    Q_D(const DFileSystemWatcher);
+
+    return d ? d->watchBudget() : 0;
+}
+
+/*!
+    Returns the number of inotify watches the watcher uses, the paths of the
+    same file share a watch.
+
+    \sa watchBudget(), polledPaths()
+*/
+int DFileSystemWatcher::watchCount() const
+{
+    Q_D(const DFileSystemWatcher);
+
+    return d ? d->watches.size() : 0;
+}
+
+/*!
+    Returns the paths which are polled because the watches are used up.
+
+    \sa setWatchBudget(), watchCount()
+*/
+QStringList DFileSystemWatcher::polledPaths() const
+{
+    Q_D(const DFileSystemWatcher);
+
+    return d ? d->polledPaths.keys() : QStringList();
+}
+
 /*!
     Removes the specified \a path from the file system watcher.
 
@@ -179,6 +179,58 @@ QStringList DFileSystemWatcher::removePaths(const QStringList &paths)
     return QStringList();
 }
 
+/*!
+    Adds the directory \a path and every directory below it to the file
+    system watcher. Not supported on this platform, returns false.
+
+    \sa addPath()
+*/
+bool DFileSystemWatcher::addRecursivePath(const QString &path)
+{
+    Q_UNUSED(path)
+    return false;
+}
+
+void DFileSystemWatcher::setReaderThreadEnabled(bool enabled)
+{
+    Q_UNUSED(enabled)
+}
+
+bool DFileSystemWatcher::isReaderThreadEnabled() const
+{
+    return false;
+}
+
+void DFileSystemWatcher::setOverflowRecoveryEnabled(bool enabled)
+{
+    Q_UNUSED(enabled)
+}
+
+bool DFileSystemWatcher::isOverflowRecoveryEnabled() const
+{
+    return false;
+}
+
+void DFileSystemWatcher::setWatchBudget(int count)
+{
+    Q_UNUSED(count)
+}
+
+int DFileSystemWatcher::watchBudget() const
+{
+    return 0;
+}
+
+int DFileSystemWatcher::watchCount() const
+{
+    return 0;
+}
+
+QStringList DFileSystemWatcher::polledPaths() const
+{
+    return QStringList();
+}
+
 /*!
     \fn void DFileSystemWatcher::fileChanged(const QString &path)
 
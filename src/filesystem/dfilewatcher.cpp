@@ -9,6 +9,16 @@
 
 #include <QDir>
 #include <QDebug>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QThread>
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <utility>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -20,6 +30,16 @@ static QString joinFilePath(const QString &path, const QString &name)
     return path + QDir::separator() + name;
 }
 
+// path is ancestor or one of its descendants.
+static bool isSameOrDescendant(const QString &path, const QString &ancestor)
+{
+    if (!path.startsWith(ancestor))
+        return false;
+
+    return path.size() == ancestor.size() || ancestor.endsWith(QDir::separator())
+            || path.at(ancestor.size()) == QDir::separator();
+}
+
 class DFileWatcherPrivate : DBaseFileWatcherPrivate
 {
 public:
@@ -36,95 +56,416 @@ public:
     void _q_handleFileModified(const QString &path, const QString &parentPath);
     void _q_handleFileClose(const QString &path, const QString &parentPath);
 
+    void handleFileDeleted(const QString &path, const QString &name);
+    void handleFileAttributeChanged(const QString &path, const QString &name);
+    void handleFileMoved(const QString &from, const QString &fromName, const QString &to, const QString &toName);
+    void handleFileCreated(const QString &path, const QString &name);
+    void handleFileModified(const QString &path, const QString &name);
+    void handleFileClosed(const QString &path, const QString &name);
+
     static QString formatPath(const QString &path);
 
     QString path;
-    QStringList watchFileList;
-
-    static QMap<QString, int> filePathToWatcherCount;
+    // registered to the dispatcher, read by the queued events without a lock.
+    std::atomic<bool> dispatched{false};
 
     Q_DECLARE_PUBLIC(DFileWatcher)
 };
 
-QMap<QString, int> DFileWatcherPrivate::filePathToWatcherCount;
-Q_GLOBAL_STATIC(DFileSystemWatcher, watcher_file_private)
+/*
+ * The paths of the watchers and their ancestors as a tree of path
+ * components, shared by all the watchers. A node counts the watchers of its
+ * path and of the paths below it, a path is watched while its count isn't 0.
+ */
+class DFileWatchTrie
+{
+public:
+    struct Node
+    {
+        Node *parent = nullptr;
+        QString name;
+        QHash<QString, Node *> children;
+        // the watchers of this path and of the paths below it.
+        int count = 0;
+        // the watchers of this path.
+        QList<DFileWatcherPrivate *> watchers;
+    };
+
+    ~DFileWatchTrie();
+
+    // returns the paths nobody watched before, the root first.
+    QStringList add(DFileWatcherPrivate *watcher);
+    // returns the paths nobody watches anymore, the deepest first.
+    QStringList remove(DFileWatcherPrivate *watcher);
+
+    const Node *find(const QString &path) const;
+    // the watchers of node and of the nodes below it.
+    static void collect(const Node *node, QList<DFileWatcherPrivate *> &watchers);
+
+private:
+    static void destroy(Node *node);
+
+    Node m_root;
+};
 
-QStringList parentPathList(const QString &path)
+DFileWatchTrie::~DFileWatchTrie()
 {
-    QStringList list;
-    QDir dir(path);
+    for (Node *child : std::as_const(m_root.children))
+        destroy(child);
+}
 
-    list << path;
+void DFileWatchTrie::destroy(Node *node)
+{
+    for (Node *child : std::as_const(node->children))
+        destroy(child);
+    delete node;
+}
 
-    while (dir.cdUp()) {
-        list << dir.absolutePath();
+QStringList DFileWatchTrie::add(DFileWatcherPrivate *watcher)
+{
+    const QString &path = watcher->path;
+    const QChar separator = QDir::separator();
+
+    QStringList newPaths;
+    Node *node = &m_root;
+    if (++node->count == 1)
+        newPaths << QString(separator);
+
+    for (int begin = 0; begin < path.size();) {
+        int end = path.indexOf(separator, begin);
+        if (end < 0)
+            end = path.size();
+        if (end > begin) {
+            const QString &name = path.mid(begin, end - begin);
+            Node *&child = node->children[name];
+            if (!child) {
+                child = new Node;
+                child->parent = node;
+                child->name = name;
+            }
+            node = child;
+            if (++node->count == 1)
+                newPaths << path.left(end);
+        }
+        begin = end + 1;
     }
 
-    return list;
+    node->watchers.append(watcher);
+    return newPaths;
 }
 
-bool DFileWatcherPrivate::start()
+QStringList DFileWatchTrie::remove(DFileWatcherPrivate *watcher)
 {
-    Q_Q(DFileWatcher);
+    Node *node = const_cast<Node *>(find(watcher->path));
+    if (!node || !node->watchers.removeOne(watcher))
+        return QStringList();
+
+    QStringList oldPaths;
+    // the path of node on the way up.
+    QString path = watcher->path;
+    while (node != &m_root) {
+        Node *parent = node->parent;
+        if (--node->count == 0) {
+            oldPaths << path;
+            parent->children.remove(node->name);
+            delete node;
+        }
+        path.truncate(path.lastIndexOf(QDir::separator()));
+        node = parent;
+    }
 
-    started = true;
+    if (--m_root.count == 0)
+        oldPaths << QString(QDir::separator());
+    return oldPaths;
+}
 
-    Q_FOREACH (const QString &path, parentPathList(this->path)) {
-        if (watchFileList.contains(path))
-            continue;
+const DFileWatchTrie::Node *DFileWatchTrie::find(const QString &path) const
+{
+    const QChar separator = QDir::separator();
+    const Node *node = &m_root;
+    for (int begin = 0; node && begin < path.size();) {
+        int end = path.indexOf(separator, begin);
+        if (end < 0)
+            end = path.size();
+        if (end > begin)
+            node = node->children.value(path.mid(begin, end - begin));
+        begin = end + 1;
+    }
+    return node;
+}
 
-        if (filePathToWatcherCount.value(path, -1) <= 0) {
-            if (!watcher_file_private->addPath(path)) {
-                qWarning() << Q_FUNC_INFO << "start watch failed, file path =" << path;
-                q->stopWatcher();
-                started = false;
-                return false;
-            }
-        }
+void DFileWatchTrie::collect(const Node *node, QList<DFileWatcherPrivate *> &watchers)
+{
+    watchers << node->watchers;
+    for (const Node *child : node->children)
+        collect(child, watchers);
+}
 
-        watchFileList << path;
-        filePathToWatcherCount[path] = filePathToWatcherCount.value(path, 0) + 1;
+/*
+ * Owns the DFileSystemWatcher shared by all the DFileWatchers, which lives
+ * in a thread of its own, so that watchers can be started on any thread.
+ * Every event is handed only to the watchers whose path, or parent path, is
+ * the path of the event, looked up in the tree of the watched paths under a
+ * read lock, and queued to the thread of each watcher. The tree is written
+ * by starting and stopping watchers only.
+ */
+class DFileWatcherDispatcher
+{
+public:
+    DFileWatcherDispatcher();
+    ~DFileWatcherDispatcher();
+
+    // watch the new paths of watcher, see DFileWatchTrie.
+    bool add(DFileWatcherPrivate *watcher);
+    bool remove(DFileWatcherPrivate *watcher);
+
+private:
+    struct Target
+    {
+        DFileWatcherPrivate *watcher;
+        QObject *object;
+    };
+    using Targets = QVarLengthArray<Target, 4>;
+
+    // must be called with m_lock held.
+    static void collect(Targets &targets, const QList<DFileWatcherPrivate *> &watchers);
+    Targets targets(const QString &path, const QString &name) const;
+    Targets movedTargets(const QString &from, const QString &fromName, const QString &to, const QString &toName) const;
+    template<typename Handler>
+    void deliver(const Targets &targets, Handler handler);
+
+    // runs function in m_thread in the order of the calls, with m_lock held for writing,
+    // at once when called in m_thread.
+    template<typename Function>
+    std::future<bool> post(Function function);
+    bool addPaths(const QStringList &paths);
+    bool removePaths(const QStringList &paths);
+
+    mutable QReadWriteLock m_lock;
+    DFileWatchTrie m_trie;
+    QThread m_thread;
+    // lives in m_thread.
+    QObject m_context;
+    DFileSystemWatcher *m_watcher = nullptr;
+};
+
+Q_GLOBAL_STATIC(DFileWatcherDispatcher, watcherDispatcher)
+
+template<typename Handler>
+void DFileWatcherDispatcher::deliver(const Targets &targets, Handler handler)
+{
+    // the objects can't be destroyed before the events are posted, the
+    // events of a destroyed object are dropped with it.
+    for (const Target &target : targets) {
+        DFileWatcherPrivate *watcher = target.watcher;
+        QMetaObject::invokeMethod(target.object, [watcher, handler] {
+            // stopped after the event was posted.
+            if (watcher->dispatched.load(std::memory_order_acquire))
+                handler(watcher);
+        }, Qt::QueuedConnection);
     }
+}
 
-    q->connect(watcher_file_private, &DFileSystemWatcher::fileDeleted,
-               q, &DFileWatcher::onFileDeleted);
-    q->connect(watcher_file_private, &DFileSystemWatcher::fileAttributeChanged,
-               q, &DFileWatcher::onFileAttributeChanged);
-    q->connect(watcher_file_private, &DFileSystemWatcher::fileMoved,
-               q, &DFileWatcher::onFileMoved);
-    q->connect(watcher_file_private, &DFileSystemWatcher::fileCreated,
-               q, &DFileWatcher::onFileCreated);
-    q->connect(watcher_file_private, &DFileSystemWatcher::fileModified,
-               q, &DFileWatcher::onFileModified);
-    q->connect(watcher_file_private, &DFileSystemWatcher::fileClosed,
-               q, &DFileWatcher::onFileClosed);
+DFileWatcherDispatcher::DFileWatcherDispatcher()
+{
+    m_thread.setObjectName("DFileWatcher");
+    m_context.moveToThread(&m_thread);
+    m_thread.start();
+
+    // the timers of the watcher belong to the thread it is created in.
+    QMetaObject::invokeMethod(&m_context, [this] {
+        m_watcher = new DFileSystemWatcher;
+        // keeps the events of a busy thread from overflowing the kernel queue.
+        if (qEnvironmentVariableIntValue("DTK_FILEWATCHER_READER_THREAD"))
+            m_watcher->setReaderThreadEnabled(true);
+
+        QObject::connect(m_watcher, &DFileSystemWatcher::fileDeleted, &m_context,
+                         [this](const QString &path, const QString &name) {
+            QReadLocker locker(&m_lock);
+            deliver(targets(path, name), [=](DFileWatcherPrivate *d) { d->handleFileDeleted(path, name); });
+        });
+        QObject::connect(m_watcher, &DFileSystemWatcher::fileAttributeChanged, &m_context,
+                         [this](const QString &path, const QString &name) {
+            QReadLocker locker(&m_lock);
+            deliver(targets(path, name), [=](DFileWatcherPrivate *d) { d->handleFileAttributeChanged(path, name); });
+        });
+        QObject::connect(m_watcher, &DFileSystemWatcher::fileMoved, &m_context,
+                         [this](const QString &from, const QString &fromName, const QString &to, const QString &toName) {
+            QReadLocker locker(&m_lock);
+            deliver(movedTargets(from, fromName, to, toName),
+                    [=](DFileWatcherPrivate *d) { d->handleFileMoved(from, fromName, to, toName); });
+        });
+        QObject::connect(m_watcher, &DFileSystemWatcher::fileCreated, &m_context,
+                         [this](const QString &path, const QString &name) {
+            QReadLocker locker(&m_lock);
+            deliver(targets(path, name), [=](DFileWatcherPrivate *d) { d->handleFileCreated(path, name); });
+        });
+        QObject::connect(m_watcher, &DFileSystemWatcher::fileModified, &m_context,
+                         [this](const QString &path, const QString &name) {
+            QReadLocker locker(&m_lock);
+            deliver(targets(path, name), [=](DFileWatcherPrivate *d) { d->handleFileModified(path, name); });
+        });
+        QObject::connect(m_watcher, &DFileSystemWatcher::fileClosed, &m_context,
+                         [this](const QString &path, const QString &name) {
+            QReadLocker locker(&m_lock);
+            deliver(targets(path, name), [=](DFileWatcherPrivate *d) { d->handleFileClosed(path, name); });
+        });
+    }, Qt::BlockingQueuedConnection);
+}
 
-    return true;
+DFileWatcherDispatcher::~DFileWatcherDispatcher()
+{
+    // the deferred deletions are done when the thread finishes.
+    m_watcher->deleteLater();
+    m_thread.quit();
+    m_thread.wait();
 }
 
-bool DFileWatcherPrivate::stop()
+template<typename Function>
+std::future<bool> DFileWatcherDispatcher::post(Function function)
 {
-    Q_Q(DFileWatcher);
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = promise->get_future();
+    // e.g. a watcher started by a handler, waiting for a queued call in m_thread would never end.
+    if (QThread::currentThread() == &m_thread) {
+        promise->set_value(function());
+        return result;
+    }
 
-    q->disconnect(watcher_file_private, 0, q, 0);
+    QMetaObject::invokeMethod(&m_context, [promise, function] {
+        promise->set_value(function());
+    }, Qt::QueuedConnection);
+    return result;
+}
 
+bool DFileWatcherDispatcher::addPaths(const QStringList &paths)
+{
+    // the path first, its ancestors are only needed for the moves.
+    for (auto path = paths.crbegin(); path != paths.crend(); ++path) {
+        if (!m_watcher->addPath(*path)) {
+            qWarning() << Q_FUNC_INFO << "start watch failed, file path =" << *path;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DFileWatcherDispatcher::removePaths(const QStringList &paths)
+{
     bool ok = true;
+    for (const QString &path : paths)
+        ok = m_watcher->removePath(path) && ok;
+    return ok;
+}
+
+bool DFileWatcherDispatcher::add(DFileWatcherPrivate *watcher)
+{
+    std::future<bool> result;
+    {
+        QWriteLocker locker(&m_lock);
+        if (watcher->dispatched)
+            return true;
+
+        watcher->dispatched = true;
+        const QStringList &paths = m_trie.add(watcher);
+        if (paths.isEmpty())
+            return true;
+
+        // posted under the lock, so that the watches are added and removed
+        // in the order the tree changed in, whatever the threads are.
+        result = post([this, paths] { return addPaths(paths); });
+    }
+    return result.get();
+}
+
+bool DFileWatcherDispatcher::remove(DFileWatcherPrivate *watcher)
+{
+    std::future<bool> result;
+    {
+        QWriteLocker locker(&m_lock);
+        if (!watcher->dispatched)
+            return true;
+
+        watcher->dispatched = false;
+        const QStringList &paths = m_trie.remove(watcher);
+        if (paths.isEmpty())
+            return true;
+
+        result = post([this, paths] { return removePaths(paths); });
+    }
+    return result.get();
+}
 
-    Q_FOREACH (const QString &path, watchFileList) {
-        int count = filePathToWatcherCount.value(path, 0);
+void DFileWatcherDispatcher::collect(Targets &targets, const QList<DFileWatcherPrivate *> &watchers)
+{
+    for (DFileWatcherPrivate *watcher : watchers) {
+        const bool found = std::any_of(targets.cbegin(), targets.cend(), [watcher](const Target &target) {
+            return target.watcher == watcher;
+        });
+        if (!found)
+            targets.append(Target{watcher, watcher->q_func()});
+    }
+}
 
-        --count;
+DFileWatcherDispatcher::Targets DFileWatcherDispatcher::targets(const QString &path, const QString &name) const
+{
+    Targets targets;
+    const DFileWatchTrie::Node *node = m_trie.find(path);
+    if (!node)
+        return targets;
+
+    // the event of the watched file itself, or of a file in the watched directory.
+    collect(targets, node->watchers);
+    if (const DFileWatchTrie::Node *child = name.isEmpty() ? nullptr : node->children.value(name))
+        collect(targets, child->watchers);
+    return targets;
+}
 
-        if (count <= 0) {
-            filePathToWatcherCount.remove(path);
-            watchFileList.removeOne(path);
-            ok = ok && watcher_file_private->removePath(path);
-        } else {
-            filePathToWatcherCount[path] = count;
-        }
+DFileWatcherDispatcher::Targets DFileWatcherDispatcher::movedTargets(const QString &from, const QString &fromName,
+                                                                     const QString &to, const QString &toName) const
+{
+    const QString &fromPath = fromName.isEmpty() ? from : joinFilePath(from, fromName);
+
+    Targets targets;
+    // moved from or to the watched directory.
+    if (!fromName.isEmpty()) {
+        if (const DFileWatchTrie::Node *node = m_trie.find(from))
+            collect(targets, node->watchers);
+    }
+    if (!toName.isEmpty()) {
+        if (const DFileWatchTrie::Node *node = m_trie.find(to))
+            collect(targets, node->watchers);
+    }
+    // the watched file or one of its ancestors is moved.
+    if (const DFileWatchTrie::Node *node = m_trie.find(fromPath)) {
+        QList<DFileWatcherPrivate *> watchers;
+        DFileWatchTrie::collect(node, watchers);
+        collect(targets, watchers);
     }
+    return targets;
+}
 
-    return ok;
+bool DFileWatcherPrivate::start()
+{
+    Q_Q(DFileWatcher);
+
+    started = true;
+
+    if (!watcherDispatcher->add(this)) {
+        q->stopWatcher();
+        started = false;
+        return false;
+    }
+
+    return true;
+}
+
+bool DFileWatcherPrivate::stop()
+{
+    if (watcherDispatcher.isDestroyed())
+        return true;
+
+    return watcherDispatcher->remove(this);
 }
 
 void DFileWatcherPrivate::_q_handleFileDeleted(const QString &path, const QString &parentPath)
@@ -132,9 +473,7 @@ void DFileWatcherPrivate::_q_handleFileDeleted(const QString &path, const QStrin
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileDeleted(QUrl::fromLocalFile(path));
+    notifyDeleted(QUrl::fromLocalFile(path));
 }
 
 void DFileWatcherPrivate::_q_handleFileAttributeChanged(const QString &path, const QString &parentPath)
@@ -142,9 +481,7 @@ void DFileWatcherPrivate::_q_handleFileAttributeChanged(const QString &path, con
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileAttributeChanged(QUrl::fromLocalFile(path));
+    notifyChanged(QUrl::fromLocalFile(path), DBaseFileWatcher::AttributeChanged);
 }
 
 void DFileWatcherPrivate::_q_handleFileMoved(const QString &from, const QString &fromParent, const QString &to, const QString &toParent)
@@ -152,11 +489,11 @@ void DFileWatcherPrivate::_q_handleFileMoved(const QString &from, const QString
     Q_Q(DFileWatcher);
 
     if ((fromParent == this->path && toParent == this->path) || from == this->path) {
-        Q_EMIT q->fileMoved(QUrl::fromLocalFile(from), QUrl::fromLocalFile(to));
+        notifyMoved(QUrl::fromLocalFile(from), QUrl::fromLocalFile(to));
     } else if (fromParent == this->path) {
-        Q_EMIT q->fileDeleted(QUrl::fromLocalFile(from));
-    } else if (watchFileList.contains(from)) {
-        Q_EMIT q->fileDeleted(url);
+        notifyDeleted(QUrl::fromLocalFile(from));
+    } else if (isSameOrDescendant(this->path, from)) {
+        notifyDeleted(url);
     } else if (toParent == this->path) {
         Q_EMIT q->subfileCreated(QUrl::fromLocalFile(to));
     }
@@ -177,9 +514,7 @@ void DFileWatcherPrivate::_q_handleFileModified(const QString &path, const QStri
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileModified(QUrl::fromLocalFile(path));
+    notifyChanged(QUrl::fromLocalFile(path), DBaseFileWatcher::Modified);
 }
 
 void DFileWatcherPrivate::_q_handleFileClose(const QString &path, const QString &parentPath)
@@ -187,9 +522,66 @@ void DFileWatcherPrivate::_q_handleFileClose(const QString &path, const QString
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
+    notifyChanged(QUrl::fromLocalFile(path), DBaseFileWatcher::Closed);
+}
 
-    Q_EMIT q->fileClosed(QUrl::fromLocalFile(path));
+void DFileWatcherPrivate::handleFileDeleted(const QString &path, const QString &name)
+{
+    if (name.isEmpty())
+        _q_handleFileDeleted(path, QString());
+    else
+        _q_handleFileDeleted(joinFilePath(path, name), path);
+}
+
+void DFileWatcherPrivate::handleFileAttributeChanged(const QString &path, const QString &name)
+{
+    if (name.isEmpty())
+        _q_handleFileAttributeChanged(path, QString());
+    else
+        _q_handleFileAttributeChanged(joinFilePath(path, name), path);
+}
+
+void DFileWatcherPrivate::handleFileMoved(const QString &from, const QString &fromName, const QString &to, const QString &toName)
+{
+    QString fromPath, fpPath;
+    QString toPath, tpPath;
+
+    if (fromName.isEmpty()) {
+        fromPath = from;
+    } else {
+        fromPath = joinFilePath(from, fromName);
+        fpPath = from;
+    }
+
+    if (toName.isEmpty()) {
+        toPath = to;
+    } else {
+        toPath = joinFilePath(to, toName);
+        tpPath = to;
+    }
+
+    _q_handleFileMoved(fromPath, fpPath, toPath, tpPath);
+}
+
+void DFileWatcherPrivate::handleFileCreated(const QString &path, const QString &name)
+{
+    _q_handleFileCreated(joinFilePath(path, name), path);
+}
+
+void DFileWatcherPrivate::handleFileModified(const QString &path, const QString &name)
+{
+    if (name.isEmpty())
+        _q_handleFileModified(path, QString());
+    else
+        _q_handleFileModified(joinFilePath(path, name), path);
+}
+
+void DFileWatcherPrivate::handleFileClosed(const QString &path, const QString &name)
+{
+    if (name.isEmpty())
+        _q_handleFileClose(path, QString());
+    else
+        _q_handleFileClose(joinFilePath(path, name), path);
 }
 
 QString DFileWatcherPrivate::formatPath(const QString &path)
@@ -208,6 +600,10 @@ QString DFileWatcherPrivate::formatPath(const QString &path)
     \inmodule dtkcore
 
     \brief The DFileWatcher class provides an implementation of DBaseFileWatcher for monitoring files and directories for modifications.
+
+    Watchers can be started and stopped on any thread. The signals of a
+    watcher are emitted in the thread the watcher lives in, which needs a
+    running event loop.
 */
 
 DFileWatcher::DFileWatcher(const QString &filePath, QObject *parent)
@@ -218,61 +614,32 @@ DFileWatcher::DFileWatcher(const QString &filePath, QObject *parent)
 
 void DFileWatcher::onFileDeleted(const QString &path, const QString &name)
 {
-    if (name.isEmpty())
-        d_func()->_q_handleFileDeleted(path, QString());
-    else
-        d_func()->_q_handleFileDeleted(joinFilePath(path, name), path);
+    d_func()->handleFileDeleted(path, name);
 }
 
 void DFileWatcher::onFileAttributeChanged(const QString &path, const QString &name)
 {
-    if (name.isEmpty())
-        d_func()->_q_handleFileAttributeChanged(path, QString());
-    else
-        d_func()->_q_handleFileAttributeChanged(joinFilePath(path, name), path);
+    d_func()->handleFileAttributeChanged(path, name);
 }
 
 void DFileWatcher::onFileMoved(const QString &from, const QString &fname, const QString &to, const QString &tname)
 {
-    QString fromPath, fpPath;
-    QString toPath, tpPath;
-
-    if (fname.isEmpty()) {
-        fromPath = from;
-    } else {
-        fromPath = joinFilePath(from, fname);
-        fpPath = from;
-    }
-
-    if (tname.isEmpty()) {
-        toPath = to;
-    } else {
-        toPath = joinFilePath(to, tname);
-        tpPath = to;
-    }
-
-    d_func()->_q_handleFileMoved(fromPath, fpPath, toPath, tpPath);
+    d_func()->handleFileMoved(from, fname, to, tname);
 }
 
 void DFileWatcher::onFileCreated(const QString &path, const QString &name)
 {
-    d_func()->_q_handleFileCreated(joinFilePath(path, name), path);
+    d_func()->handleFileCreated(path, name);
 }
 
 void DFileWatcher::onFileModified(const QString &path, const QString &name)
 {
-    if (name.isEmpty())
-        d_func()->_q_handleFileModified(path, QString());
-    else
-        d_func()->_q_handleFileModified(joinFilePath(path, name), path);
+    d_func()->handleFileModified(path, name);
 }
 
 void DFileWatcher::onFileClosed(const QString &path, const QString &name)
 {
-    if (name.isEmpty())
-        d_func()->_q_handleFileClose(path, QString());
-    else
-        d_func()->_q_handleFileClose(joinFilePath(path, name), path);
+    d_func()->handleFileClosed(path, name);
 }
 
 DCORE_END_NAMESPACE
@@ -6,9 +6,17 @@
 #define DBASEFILEWATCHER_P_H
 
 #include "base/private/dobject_p.h"
+#include "dbasefilewatcher.h"
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
 #include <QUrl>
 
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 DCORE_BEGIN_NAMESPACE
 
 class DBaseFileWatcher;
@@ -20,9 +28,33 @@ public:
     virtual bool start() = 0;
     virtual bool stop() = 0;
 
+    // emit the change signals of url, merged in the coalescing window if there is one.
+    void notifyChanged(const QUrl &url, DBaseFileWatcher::ChangeFlag change);
+    void notifyMoved(const QUrl &fromUrl, const QUrl &toUrl);
+    void notifyDeleted(const QUrl &url);
+    void deliverChanges(const QUrl &url, DBaseFileWatcher::ChangeFlags changes);
+    void deliverCoalescedChanges();
+    void clearCoalescedChanges();
+
     QUrl url;
     bool started = false;
+    // the watchers of every thread, guarded by watcherListMutex.
     static QList<DBaseFileWatcher *> watcherList;
+    static QMutex watcherListMutex;
+    static QList<DBaseFileWatcher *> watchersOf(const QUrl &url);
+
+    struct PendingChanges
+    {
+        DBaseFileWatcher::ChangeFlags changes;
+        // the end of the window, by coalescingClock.
+        qint64 deadline = 0;
+    };
+
+    int coalescingWindow = 0;
+    DBaseFileWatcher::DeliveryFlags coalescingDelivery = DBaseFileWatcher::TrailingDelivery;
+    QHash<QUrl, PendingChanges> pendingChanges;
+    QTimer *coalescingTimer = nullptr;
+    QElapsedTimer coalescingClock;
 
     D_DECLARE_PUBLIC(DBaseFileWatcher)
 };
@@ -8,11 +8,203 @@
 #include "dobject_p.h"
 
 #include <QSocketNotifier>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QMap>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <sys/inotify.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_set>
 
 DCORE_BEGIN_NAMESPACE
 
+/*
+ * The watched paths by watch descriptor. The kernel hands out the descriptors
+ * of an inotify fd in increasing order, so they are their own hash: an open
+ * addressing table of watches is indexed by the descriptor modulo its
+ * capacity, without a node per watch. A watch holds its first path, the
+ * string pathToID holds, the other paths of the same file are kept aside.
+ */
+class DInotifyWatchTable
+{
+public:
+    struct Watch
+    {
+        // 0 for a free slot, the kernel starts with 1.
+        int wd = 0;
+        bool isDirectory = false;
+        QString path;
+    };
+
+    // the paths of a watch in the order they were added, without allocating.
+    using Paths = QVarLengthArray<QString, 2>;
+
+    // nullptr if wd isn't watched.
+    const Watch *find(int wd) const;
+    Paths paths(int wd) const;
+    int pathCount(int wd) const;
+    void insert(int wd, bool isDirectory, const QString &path);
+    // returns true if path was the last one of wd.
+    bool remove(int wd, const QString &path);
+    // the number of watch descriptors.
+    int size() const { return m_size; }
+
+private:
+    int indexOf(int wd) const;
+    void rehash(int capacity);
+
+    QVector<Watch> m_slots;
+    int m_size = 0;
+    QMultiHash<int, QString> m_morePaths;
+};
+
+/*
+ * The events of one read from the inotify fd, in the order they are read.
+ * An event equal to an earlier one (wd, mask, cookie and name) is dropped,
+ * the events of unknown watches as well.
+ */
+class DInotifyEventBatch
+{
+public:
+    explicit DInotifyEventBatch(const DInotifyWatchTable &watches);
+
+    // the events point into buffer, it must outlive the batch. The events of
+    // unknown watches are appended to unknownEvents if it's given.
+    void parse(const char *buffer, qint64 size, QByteArray *unknownEvents = nullptr);
+
+    // the watched paths of wd, id is negative for a directory.
+    DInotifyWatchTable::Paths paths(int wd, int *id) const;
+
+    QVector<const inotify_event *> events;
+    /// only save event: IN_MOVE_TO
+    QMultiMap<int, QString> cookieToFilePath;
+    QMultiMap<int, QString> cookieToFileName;
+    QSet<int> hasMoveFromByCookie;
+    int duplicateCount = 0;
+    // the kernel queue overflowed, events are missing.
+    bool overflowed = false;
+
+private:
+    struct EventHash
+    {
+        size_t operator()(const inotify_event *event) const;
+    };
+
+    struct EventEqual
+    {
+        bool operator()(const inotify_event *a, const inotify_event *b) const;
+    };
+
+    const DInotifyWatchTable &m_watches;
+    std::unordered_set<const inotify_event *, EventHash, EventEqual> m_seen;
+};
+
+// a directory watched by a sweep of a recursive watch.
+struct DInotifySweptDirectory
+{
+    QString path;
+    int wd = -1;
+    // there was no watch left for the directory, it's polled.
+    bool polled = false;
+    // the entries found in the directory of a new tree.
+    QStringList names;
+};
+
+// an entry of a watched directory as the overflow recovery knows it.
+struct DInotifySnapshotEntry
+{
+    // 0 and -1 if they are unknown: the entry was reported by an event.
+    quint64 inode = 0;
+    qint64 mtime = -1;
+    qint64 size = -1;
+    qint64 ctime = -1;
+    bool isDirectory = false;
+};
+
+// the entries of a directory by their name.
+using DInotifySnapshot = QHash<QString, DInotifySnapshotEntry>;
+
+// the differences between two snapshots of directories.
+struct DInotifySnapshotChanges
+{
+    struct Change
+    {
+        QString path;
+        QString name;
+        DInotifySnapshotEntry entry;
+    };
+
+    void diff(const QString &path, const DInotifySnapshot &before, const DInotifySnapshot &after);
+    bool isEmpty() const;
+
+    QVector<Change> deleted;
+    QVector<Change> created;
+    QVector<Change> modified;
+    QVector<Change> attributeChanged;
+};
+
+/*
+ * Drains the inotify fd in a thread of its own, so that a busy thread of the
+ * watcher doesn't let the kernel queue overflow. The reads are handed over by
+ * a lock-free stack, the thread of the watcher takes all of them at once when
+ * it's woken, which happens once per take().
+ */
+class DInotifyReader
+{
+public:
+    DInotifyReader(int fd, std::function<void()> wake);
+    ~DInotifyReader();
+
+    bool isRunning() const;
+    // the reads which weren't taken are kept.
+    void stop();
+    // the reads since the last call, in the order they were read.
+    QByteArray take();
+
+private:
+    struct Chunk
+    {
+        QByteArray data;
+        Chunk *next = nullptr;
+    };
+
+    void run();
+    void push(QByteArray &&data);
+
+    int m_fd;
+    int m_stopFd = -1;
+    std::function<void()> m_wake;
+    std::atomic<Chunk *> m_head{nullptr};
+    std::atomic<bool> m_wakePending{false};
+    std::atomic<qint64> m_queuedSize{0};
+    std::thread m_thread;
+};
+
+// a path which is polled because the watches are used up.
+struct DPolledPath
+{
+    bool isDirectory = false;
+    // the status of the path, its inode is 0 if it doesn't exist.
+    DInotifySnapshotEntry self;
+    DInotifySnapshot entries;
+    int interval = 0;
+    qint64 due = 0;
+    // the entries are scanned in sweepPool, by the latest scan only.
+    quint64 scan = 0;
+    bool scanned = false;
+    bool scanning = false;
+    bool scanAgain = false;
+};
+
 class DFileSystemWatcher;
 class DFileSystemWatcherPrivate : public DObjectPrivate
 {
@@ -25,14 +217,77 @@ public:
     QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories);
     QStringList removePaths(const QStringList &paths, QStringList *files, QStringList *directories);
 
+    bool addRecursivePath(const QString &path);
+    void sweep(const QString &root, const QString &path, bool replay);
+    void addSweptDirectories(const QString &root, const QVector<DInotifySweptDirectory> &swept);
+    void finishSweep();
+    void removeRecursiveTree(const QString &path);
+    QString recursiveRootOf(const QString &path) const;
+    void setReaderThreadEnabled(bool enabled);
+    void setOverflowRecoveryEnabled(bool enabled);
+    void snapshotDirectories(const QStringList &paths);
+    void requestRescan();
+    void startRescan();
+    void finishRescan(const QHash<QString, DInotifySnapshot> &scanned, bool report);
+    void emitSnapshotChanges(const DInotifySnapshotChanges &changes);
+    void updateSnapshot(const QString &path, const QString &name, quint32 mask);
+
+    int watchBudget() const;
+    // -1 and errno ENOSPC if the budget is used up.
+    int addWatch(const QString &path, bool isDirectory, bool mayDemote);
+    bool demoteFileWatch();
+    void promotePolledPaths();
+    void startPolling(const QString &path, bool isDirectory);
+    void schedulePoll(const QString &path, DPolledPath &polled);
+    void pollDuePaths();
+    void poll(const QString &path, qint64 due);
+    void scanPolledDirectory(const QString &path, DPolledPath &polled);
+    void finishPollScan(const QString &path, quint64 scan, const DInotifySnapshot &entries, bool ok);
+
     QStringList files, directories;
     int inotifyFd;
+    // negative ids are directories.
     QHash<QString, int> pathToID;
-    QMultiHash<int, QString> idToPath;
+    DInotifyWatchTable watches;
     QSocketNotifier notifier;
 
+    // the directories added by addRecursivePath().
+    QSet<QString> recursiveRoots;
+    // the directories watched because they are below a recursive root, and their root,
+    // ordered so that a subtree is a range.
+    QMap<QString, QString> recursiveDirectories;
+    QThreadPool sweepPool;
+    std::atomic<bool> sweepCancelled{false};
+    int sweepsInProgress = 0;
+    // the watches the sweeps may add, set when the first of them starts.
+    std::atomic<int> sweepAllowance{0};
+    QByteArray pendingEvents;
+
+    std::unique_ptr<DInotifyReader> reader;
+
+    // the snapshots of the watched directories, diffed with a rescan after an overflow.
+    bool overflowRecovery = false;
+    QHash<QString, DInotifySnapshot> snapshots;
+    bool rescanInProgress = false;
+    bool rescanRequested = false;
+    // one rescan per interval at most.
+    QTimer rescanTimer;
+
+    int maxUserWatches = 0;
+    // set by DFileSystemWatcher::setWatchBudget(), 0 if there is no limit.
+    int maxWatchCount = 0;
+    QHash<QString, DPolledPath> polledPaths;
+    // the paths by the time of their next poll, by pollClock.
+    QMultiMap<qint64, QString> pollSchedule;
+    QTimer pollTimer;
+    QElapsedTimer pollClock;
+    bool pollingWarned = false;
+    quint64 pollScans = 0;
+
     // private slots
     void _q_readFromInotify();
+    void readFromReader();
+    void processEvents(const char *buffer, qint64 size);
 
 private:
     void onFileChanged(const QString &path, bool removed);
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "AsyncAppender.h"
+
+#include <QList>
+#include <QThread>
+
+DCORE_BEGIN_NAMESPACE
+
+// the writer wakes up by itself after this interval even if nobody notified it.
+static constexpr int WriterIdleInterval = 100;
+
+struct AsyncAppenderList
+{
+    QMutex mutex;
+    QList<AsyncAppender *> appenders;
+};
+Q_GLOBAL_STATIC(AsyncAppenderList, livingAppenders)
+
+class AsyncAppenderThread : public QThread
+{
+public:
+    explicit AsyncAppenderThread(AsyncAppender *appender)
+        : m_appender(appender)
+    {
+        setObjectName("AsyncAppender");
+    }
+
+protected:
+    void run() override
+    {
+        m_appender->run();
+    }
+
+private:
+    AsyncAppender *m_appender;
+};
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::AsyncAppender
+
+  \brief AsyncAppender queues the log records into a bounded queue, a background
+  thread takes them out in batches and writes them to the \a target appender.
+
+  When the queue is full the record is handled by the \a policy. A Logger::Fatal
+  record is written before append() returns, and the remaining records are
+  written when the appender is destroyed.
+ */
+AsyncAppender::AsyncAppender(AbstractAppender *target, OverflowPolicy policy, int capacity)
+    : m_target(target)
+    , m_policy(policy)
+    , m_capacity(qMax(capacity, 1))
+    , m_thread(new AsyncAppenderThread(this))
+{
+    m_thread->start();
+
+    if (auto list = livingAppenders()) {
+        QMutexLocker locker(&list->mutex);
+        list->appenders.append(this);
+    }
+}
+
+AsyncAppender::~AsyncAppender()
+{
+    if (auto list = livingAppenders()) {
+        QMutexLocker locker(&list->mutex);
+        list->appenders.removeOne(this);
+    }
+
+    m_stopping.store(true);
+    wakeWriter();
+    m_thread->wait();
+}
+
+void AsyncAppender::flush()
+{
+    // the writer thread itself logged something, it can't wait for itself.
+    if (QThread::currentThread() == m_thread.get() || !m_thread->isRunning())
+        return;
+
+    const quint64 accepted = m_accepted.load();
+    wakeWriter();
+
+    QMutexLocker locker(&m_mutex);
+    while (m_written.load() < accepted && m_thread->isRunning())
+        m_recordsWritten.wait(&m_mutex, WriterIdleInterval);
+}
+
+void AsyncAppender::flushAll()
+{
+    auto list = livingAppenders();
+    if (!list)
+        return;
+
+    QMutexLocker locker(&list->mutex);
+    for (auto appender : list->appenders)
+        appender->flush();
+}
+
+void AsyncAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                           const char *function, const QString &category, const QString &message)
+{
+    Record record{time, level, file, line, function, category, message};
+
+    // don't block the writer thread on its own queue.
+    const bool canBlock = m_policy == DLogManager::BlockWhenFull && QThread::currentThread() != m_thread.get();
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_records.size() >= m_capacity) {
+            if (!canBlock || m_stopping.load()) {
+                m_dropped.fetch_add(1);
+                if (m_policy == DLogManager::DropAndCountWhenFull)
+                    m_unreported.fetch_add(1);
+                return;
+            }
+
+            m_recordsAvailable.wakeOne();
+            m_recordsWritten.wait(&m_mutex, WriterIdleInterval);
+        }
+
+        m_records.append(std::move(record));
+        m_accepted.fetch_add(1);
+        if (m_writerWaiting)
+            m_recordsAvailable.wakeOne();
+    }
+
+    // the process is going to abort, write all records before returning.
+    if (level == Logger::Fatal)
+        flush();
+}
+
+void AsyncAppender::wakeWriter()
+{
+    QMutexLocker locker(&m_mutex);
+    m_recordsAvailable.wakeOne();
+}
+
+void AsyncAppender::writeDropReport()
+{
+    const quint64 count = m_unreported.exchange(0);
+    if (count == 0)
+        return;
+
+    m_target->write(QDateTime::currentDateTime(), Logger::Warning, __FILE__, __LINE__, Q_FUNC_INFO,
+                    QString(), QString("%1 log records were dropped, the log queue is full").arg(count));
+}
+
+void AsyncAppender::run()
+{
+    QVector<Record> records;
+    for (;;) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_recordsWritten.wakeAll();
+
+            if (m_records.isEmpty()) {
+                if (m_stopping.load())
+                    break;
+
+                m_writerWaiting = true;
+                m_recordsAvailable.wait(&m_mutex, WriterIdleInterval);
+                m_writerWaiting = false;
+            }
+
+            // the producers go on with the emptied vector while the records are written.
+            records.swap(m_records);
+            if (!records.isEmpty())
+                m_recordsWritten.wakeAll();
+        }
+
+        for (const Record &record : std::as_const(records)) {
+            m_target->write(record.time, record.level, record.file, record.line,
+                            record.function, record.category, record.message);
+        }
+        m_written.fetch_add(quint64(records.size()));
+        records.clear();
+        writeDropReport();
+    }
+}
+
+DCORE_END_NAMESPACE
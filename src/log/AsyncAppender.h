@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef ASYNCAPPENDER_H
+#define ASYNCAPPENDER_H
+
+#include <QDateTime>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <memory>
+
+#include <AbstractAppender.h>
+
+#include "dtkcore_global.h"
+#include "LogManager.h"
+
+DCORE_BEGIN_NAMESPACE
+
+class AsyncAppenderThread;
+
+/*
+ * Hands the records to a background thread which writes them to the target
+ * appender, so that formatting and file I/O don't happen on the logging thread.
+ * AbstractAppender::write() serializes the producers already, the records are
+ * queued under a mutex and the writer takes all of them at once.
+ */
+class AsyncAppender : public AbstractAppender
+{
+    Q_DISABLE_COPY(AsyncAppender)
+public:
+    // BlockWhenFull waits until the writer thread makes room, DropWhenFull discards the
+    // record, DropAndCountWhenFull discards it and logs how many records were discarded.
+    using OverflowPolicy = DLogManager::OverflowPolicy;
+
+    // takes the ownership of `target`, it must not be registered to a Logger.
+    explicit AsyncAppender(AbstractAppender *target, OverflowPolicy policy = DLogManager::BlockWhenFull, int capacity = 8192);
+    ~AsyncAppender() override;
+
+    AbstractAppender *target() const { return m_target.get(); }
+    OverflowPolicy overflowPolicy() const { return m_policy; }
+    int capacity() const { return m_capacity; }
+    quint64 droppedCount() const { return m_dropped.load(); }
+
+    // blocks until every record accepted so far is written to the target.
+    void flush();
+    // flushes every living AsyncAppender.
+    static void flushAll();
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *function, const QString &category, const QString &message) override;
+
+private:
+    struct Record
+    {
+        QDateTime time;
+        Logger::LogLevel level = Logger::Debug;
+        const char *file = nullptr;
+        int line = 0;
+        const char *function = nullptr;
+        QString category;
+        QString message;
+    };
+
+    friend class AsyncAppenderThread;
+    void run();
+    void wakeWriter();
+    void writeDropReport();
+
+    std::unique_ptr<AbstractAppender> m_target;
+    const OverflowPolicy m_policy;
+    const int m_capacity;
+
+    std::atomic<quint64> m_accepted{0};
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_unreported{0};
+    std::atomic<bool> m_stopping{false};
+
+    // guards m_records and m_writerWaiting.
+    QMutex m_mutex;
+    QVector<Record> m_records;
+    bool m_writerWaiting = false;
+    QWaitCondition m_recordsAvailable;
+    QWaitCondition m_recordsWritten;
+    std::unique_ptr<AsyncAppenderThread> m_thread;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // ASYNCAPPENDER_H
@@ -0,0 +1,396 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "BinaryAppender.h"
+
+#include <QThread>
+#include <QtEndian>
+
+#include <cstring>
+
+DCORE_BEGIN_NAMESPACE
+
+// the buffered data is written to the file when it grows over this size.
+static constexpr int BufferSize = 16 * 1024;
+// ids per segment, a long living process starts a new segment with empty string tables.
+static constexpr int StringTableLimit = 64 * 1024;
+// the buffered records are written after this interval at the latest, a crash loses no more.
+static constexpr int FlushInterval = 1000;
+
+static inline void appendVarint(QByteArray &buffer, quint64 value)
+{
+    char bytes[10];
+    int size = 0;
+    do {
+        quint8 byte = value & 0x7f;
+        value >>= 7;
+        if (value)
+            byte |= 0x80;
+        bytes[size++] = char(byte);
+    } while (value);
+    buffer.append(bytes, size);
+}
+
+static inline quint64 zigzag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+static inline qint64 unzigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+class BinaryAppenderFlusher : public QThread
+{
+public:
+    explicit BinaryAppenderFlusher(BinaryAppender *appender)
+        : m_appender(appender)
+    {
+        setObjectName("BinaryAppender");
+    }
+
+protected:
+    void run() override
+    {
+        m_appender->run();
+    }
+
+private:
+    BinaryAppender *m_appender;
+};
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::BinaryAppender
+
+  \brief BinaryAppender writes log records in a compact binary format.
+
+  Instead of formatting a text line, a record only stores the time difference
+  to the previous record, the level, the ids of its category and source
+  location and the message. Category, file and function names are written
+  once, the first time they are used. The message itself is the text formatted
+  by the Qt message handler, stored as UTF-8, so the file is smaller than the
+  text log by the size of the record metadata, not by the size of the messages.
+  Use the dtk-log-decoder tool or BinaryLogReader to turn the file back into text.
+
+  The records are buffered, a background thread writes them to the file at
+  most a second after they are logged.
+
+  When the file grows over \a sizeLimit it's renamed with a `.1` suffix,
+  replacing the previous one, and a new file is started.
+ */
+BinaryAppender::BinaryAppender(const QString &fileName, qint64 sizeLimit)
+    : m_file(fileName)
+    , m_sizeLimit(sizeLimit)
+{
+    m_buffer.reserve(BufferSize * 2);
+    m_flusher.reset(new BinaryAppenderFlusher(this));
+    m_flusher->start();
+}
+
+BinaryAppender::~BinaryAppender()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_dataBuffered.wakeOne();
+    }
+    m_flusher->wait();
+    flush();
+}
+
+void BinaryAppender::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    writeBuffer();
+}
+
+void BinaryAppender::run()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        if (m_buffer.isEmpty()) {
+            m_dataBuffered.wait(&m_mutex);
+            continue;
+        }
+
+        // append() only wakes it for the first record of an empty buffer.
+        m_dataBuffered.wait(&m_mutex, FlushInterval);
+        writeBuffer();
+    }
+}
+
+void BinaryAppender::writeBuffer()
+{
+    if (m_buffer.isEmpty() || !m_file.isOpen())
+        return;
+
+    m_fileSize += qMax<qint64>(m_file.write(m_buffer), 0);
+    m_file.flush();
+    m_buffer.clear();
+}
+
+bool BinaryAppender::openSegment()
+{
+    if (!m_file.isOpen() && !m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning("Can't open the binary log file \"%s\": %s", qPrintable(m_file.fileName()),
+                 qPrintable(m_file.errorString()));
+        return false;
+    }
+
+    m_fileSize = m_file.size();
+    m_literals.clear();
+    m_strings.clear();
+    m_locations.clear();
+    m_nextId = 1;
+    m_lastTime = QDateTime::currentMSecsSinceEpoch();
+
+    char header[BinaryLog::MagicSize + 1 + 8];
+    memcpy(header, BinaryLog::Magic, BinaryLog::MagicSize);
+    header[BinaryLog::MagicSize] = char(BinaryLog::Version);
+    qToLittleEndian<qint64>(m_lastTime, header + BinaryLog::MagicSize + 1);
+    m_buffer.append(header, sizeof(header));
+    return true;
+}
+
+void BinaryAppender::rotate()
+{
+    const QString fileName = m_file.fileName();
+    m_file.close();
+
+    const QString &backup = fileName + QStringLiteral(".1");
+    QFile::remove(backup);
+    QFile::rename(fileName, backup);
+    // the ids of the new file start over in openSegment().
+}
+
+quint32 BinaryAppender::newString(const QByteArray &utf8)
+{
+    const quint32 id = m_nextId++;
+    m_buffer.append(char(BinaryLog::StringTag));
+    appendVarint(m_buffer, id);
+    appendVarint(m_buffer, quint64(utf8.size()));
+    m_buffer.append(utf8);
+    return id;
+}
+
+quint32 BinaryAppender::literalId(const char *text)
+{
+    if (!text || !*text)
+        return 0;
+
+    auto it = m_literals.find(text);
+    // the address may be reused by a different string which isn't a literal.
+    if (it != m_literals.end() && qstrcmp(it->text.constData(), text) == 0)
+        return it->id;
+
+    const QByteArray utf8(text);
+    const quint32 id = newString(utf8);
+    m_literals.insert(text, CachedLiteral{utf8, id});
+    return id;
+}
+
+quint32 BinaryAppender::stringId(const QString &text)
+{
+    if (text.isEmpty())
+        return 0;
+
+    auto it = m_strings.constFind(text);
+    if (it != m_strings.constEnd())
+        return it.value();
+
+    const quint32 id = newString(text.toUtf8());
+    m_strings.insert(text, id);
+    return id;
+}
+
+void BinaryAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                            const char *function, const QString &category, const QString &message)
+{
+    QMutexLocker locker(&m_mutex);
+    // the flusher waits for the first record of an empty buffer.
+    const bool wasEmpty = m_buffer.isEmpty();
+    // rotate before writing, so the current file is never left without records.
+    if (m_file.isOpen() && m_sizeLimit > 0 && m_fileSize + m_buffer.size() > m_sizeLimit) {
+        writeBuffer();
+        rotate();
+    }
+
+    if (!m_file.isOpen() || m_nextId > StringTableLimit) {
+        writeBuffer();
+        if (!openSegment())
+            return;
+    }
+
+    const quint32 categoryId = stringId(category);
+    const quint32 fileId = literalId(file);
+    const quint32 functionId = literalId(function);
+
+    quint32 locationId = 0;
+    if (fileId || functionId || line) {
+        const Location location(quint64(fileId) << 32 | functionId, line);
+        auto it = m_locations.constFind(location);
+        if (it != m_locations.constEnd()) {
+            locationId = it.value();
+        } else {
+            locationId = m_nextId++;
+            m_buffer.append(char(BinaryLog::LocationTag));
+            appendVarint(m_buffer, locationId);
+            appendVarint(m_buffer, fileId);
+            appendVarint(m_buffer, functionId);
+            appendVarint(m_buffer, zigzag(line));
+            m_locations.insert(location, locationId);
+        }
+    }
+
+    const qint64 msecs = time.toMSecsSinceEpoch();
+    const QByteArray &utf8 = message.toUtf8();
+    m_buffer.append(char(BinaryLog::RecordTag));
+    appendVarint(m_buffer, zigzag(msecs - m_lastTime));
+    m_buffer.append(char(level));
+    appendVarint(m_buffer, categoryId);
+    appendVarint(m_buffer, locationId);
+    appendVarint(m_buffer, quint64(utf8.size()));
+    m_buffer.append(utf8);
+    m_lastTime = msecs;
+
+    if (m_buffer.size() >= BufferSize || level >= Logger::Error)
+        writeBuffer();
+    else if (wasEmpty)
+        m_dataBuffered.wakeOne();
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::BinaryLogReader
+
+  \brief BinaryLogReader reads the records written by BinaryAppender.
+ */
+BinaryLogReader::BinaryLogReader(const QString &fileName)
+    : m_file(fileName)
+{
+}
+
+bool BinaryLogReader::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    m_data = m_file.readAll();
+    m_pos = 0;
+    if (!readSegmentHeader()) {
+        m_error = QStringLiteral("Not a binary log file");
+        return false;
+    }
+    return true;
+}
+
+bool BinaryLogReader::readSegmentHeader()
+{
+    const int headerSize = BinaryLog::MagicSize + 1 + 8;
+    if (m_data.size() - m_pos < headerSize
+        || memcmp(m_data.constData() + m_pos, BinaryLog::Magic, BinaryLog::MagicSize) != 0
+        || quint8(m_data.at(m_pos + BinaryLog::MagicSize)) != BinaryLog::Version)
+        return false;
+
+    m_time = qFromLittleEndian<qint64>(m_data.constData() + m_pos + BinaryLog::MagicSize + 1);
+    m_pos += headerSize;
+    m_strings.clear();
+    m_locations.clear();
+    return true;
+}
+
+bool BinaryLogReader::readVarint(quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_pos >= m_data.size())
+            return false;
+        const quint8 byte = quint8(m_data.at(m_pos++));
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool BinaryLogReader::readBytes(quint64 size, QByteArray &bytes)
+{
+    if (size > quint64(m_data.size() - m_pos))
+        return false;
+
+    bytes = m_data.mid(m_pos, int(size));
+    m_pos += qint64(size);
+    return true;
+}
+
+bool BinaryLogReader::next(BinaryLog::Record &record)
+{
+    auto damaged = [this]() {
+        m_error = QStringLiteral("The binary log file is damaged at offset %1").arg(m_pos);
+        return false;
+    };
+
+    while (m_pos < m_data.size()) {
+        const quint8 tag = quint8(m_data.at(m_pos));
+        if (tag == quint8(BinaryLog::Magic[0])) {
+            if (!readSegmentHeader())
+                return damaged();
+            continue;
+        }
+
+        ++m_pos;
+        quint64 id = 0;
+        switch (tag) {
+        case BinaryLog::StringTag: {
+            quint64 size = 0;
+            QByteArray text;
+            if (!readVarint(id) || !readVarint(size) || !readBytes(size, text))
+                return damaged();
+            m_strings.insert(quint32(id), text);
+            break;
+        }
+        case BinaryLog::LocationTag: {
+            quint64 file = 0, function = 0, line = 0;
+            if (!readVarint(id) || !readVarint(file) || !readVarint(function) || !readVarint(line))
+                return damaged();
+            m_locations.insert(quint32(id), Location{quint32(file), quint32(function), int(unzigzag(line))});
+            break;
+        }
+        case BinaryLog::RecordTag: {
+            quint64 delta = 0, category = 0, location = 0, size = 0;
+            QByteArray message;
+            if (!readVarint(delta) || m_pos >= m_data.size())
+                return damaged();
+            const quint8 level = quint8(m_data.at(m_pos++));
+            if (level > Logger::Fatal || !readVarint(category) || !readVarint(location)
+                || !readVarint(size) || !readBytes(size, message))
+                return damaged();
+
+            m_time += unzigzag(delta);
+            const Location &loc = m_locations.value(quint32(location), Location{0, 0, 0});
+            record.time = QDateTime::fromMSecsSinceEpoch(m_time);
+            record.level = static_cast<Logger::LogLevel>(level);
+            record.file = m_strings.value(loc.file);
+            record.function = m_strings.value(loc.function);
+            record.line = loc.line;
+            record.category = QString::fromUtf8(m_strings.value(quint32(category)));
+            record.message = QString::fromUtf8(message);
+            return true;
+        }
+        default:
+            --m_pos;
+            return damaged();
+        }
+    }
+
+    return false;
+}
+
+DCORE_END_NAMESPACE
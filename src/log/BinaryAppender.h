@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef BINARYAPPENDER_H
+#define BINARYAPPENDER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <memory>
+
+#include <AbstractAppender.h>
+
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Binary log file layout, integers are little endian varints unless noted.
+ *
+ *   segment:  "DTKBLOG" version(u8) baseTime(i64 le, msecs since epoch) entry*
+ *   entry:    tag(u8) ...
+ *     String:   id length utf8[length]
+ *     Location: id fileStringId functionStringId line
+ *     Record:   timeDelta(zigzag msecs) level(u8) categoryStringId locationId length utf8[length]
+ *
+ * Strings and locations are written once, the first time a record uses them,
+ * id 0 is the empty string or an unknown location. Each time a file is opened
+ * for writing a new segment starts, ids are only valid in their segment.
+ */
+namespace BinaryLog {
+static constexpr char Magic[] = "DTKBLOG";
+static constexpr int MagicSize = 7;
+static constexpr quint8 Version = 1;
+
+enum Tag : quint8 {
+    StringTag = 1,
+    LocationTag = 2,
+    RecordTag = 3
+};
+
+struct Record
+{
+    QDateTime time;
+    Logger::LogLevel level = Logger::Debug;
+    QByteArray file;
+    QByteArray function;
+    int line = 0;
+    QString category;
+    QString message;
+};
+}
+
+class BinaryAppenderFlusher;
+
+/*
+ * Writes the records in the binary log format, no text formatting happens
+ * when logging. The messages come formatted from the Qt message handler and
+ * are stored as text, only the metadata of a record is compacted. The data
+ * is buffered and written when the buffer is full, for an Error or Fatal
+ * record, at most a second after it's buffered and when the appender is
+ * destroyed.
+ */
+class BinaryAppender : public AbstractAppender
+{
+    Q_DISABLE_COPY(BinaryAppender)
+public:
+    explicit BinaryAppender(const QString &fileName, qint64 sizeLimit = 20 * 1024 * 1024);
+    ~BinaryAppender() override;
+
+    QString fileName() const { return m_file.fileName(); }
+    qint64 sizeLimit() const { return m_sizeLimit; }
+    void flush();
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *function, const QString &category, const QString &message) override;
+
+private:
+    // (file string id << 32 | function string id, line)
+    using Location = QPair<quint64, int>;
+
+    struct CachedLiteral
+    {
+        QByteArray text;
+        quint32 id;
+    };
+
+    friend class BinaryAppenderFlusher;
+    void run();
+    void writeBuffer();
+    bool openSegment();
+    quint32 literalId(const char *text);
+    quint32 stringId(const QString &text);
+    quint32 newString(const QByteArray &utf8);
+    void rotate();
+
+    QFile m_file;
+    qint64 m_sizeLimit;
+    QByteArray m_buffer;
+    qint64 m_fileSize = 0;
+    qint64 m_lastTime = 0;
+    quint32 m_nextId = 1;
+    QHash<const char *, CachedLiteral> m_literals;
+    QHash<QString, quint32> m_strings;
+    QHash<Location, quint32> m_locations;
+
+    // guards the buffer and the file, the flusher writes them in the background.
+    QMutex m_mutex;
+    QWaitCondition m_dataBuffered;
+    bool m_stopping = false;
+    std::unique_ptr<BinaryAppenderFlusher> m_flusher;
+};
+
+/*
+ * Reads the records of a binary log file written by BinaryAppender.
+ */
+class BinaryLogReader
+{
+public:
+    explicit BinaryLogReader(const QString &fileName);
+
+    bool open();
+    QString errorString() const { return m_error; }
+    // returns false at the end of the file or for a damaged file, see errorString().
+    bool next(BinaryLog::Record &record);
+
+private:
+    bool readSegmentHeader();
+    bool readVarint(quint64 &value);
+    bool readBytes(quint64 size, QByteArray &bytes);
+
+    QFile m_file;
+    QByteArray m_data;
+    qint64 m_pos = 0;
+    qint64 m_time = 0;
+    QString m_error;
+    QHash<quint32, QByteArray> m_strings;
+    struct Location
+    {
+        quint32 file;
+        quint32 function;
+        int line;
+    };
+    QHash<quint32, Location> m_locations;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // BINARYAPPENDER_H
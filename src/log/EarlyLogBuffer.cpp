@@ -0,0 +1,193 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "EarlyLogBuffer.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QLoggingCategory>
+
+#include <Logger.h>
+
+#include <cstdio>
+
+DCORE_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(EarlyLogBuffer, globalEarlyLogBuffer)
+
+static QtMessageHandler previousHandler = nullptr;
+static QLoggingCategory::CategoryFilter previousFilter = nullptr;
+
+// the message types the categories of the process enable, as the category filter left them.
+struct CategoryStates
+{
+    QMutex mutex;
+    QHash<QByteArray, quint8> enabledTypes;
+};
+Q_GLOBAL_STATIC(CategoryStates, categoryStates)
+
+static quint8 typeBit(QtMsgType type)
+{
+    return quint8(1u << type);
+}
+
+static Logger::LogLevel levelOf(QtMsgType type)
+{
+    switch (type) {
+    case QtDebugMsg:
+        return Logger::Debug;
+    case QtInfoMsg:
+        return Logger::Info;
+    case QtWarningMsg:
+        return Logger::Warning;
+    case QtCriticalMsg:
+        return Logger::Error;
+    case QtFatalMsg:
+        return Logger::Fatal;
+    }
+    return Logger::Debug;
+}
+
+static void releaseEarlyLogBuffer()
+{
+    EarlyLogBuffer::instance()->release();
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::EarlyLogBuffer
+
+  \brief EarlyLogBuffer holds back the messages logged before the logging rules are known.
+
+  The logging rules are read from DConfig asynchronously, the debug and info
+  messages logged meanwhile would be written with the default rules. They are
+  kept instead, up to \a capacity messages, and written once the rules are
+  applied, when the buffer is full or its timeout is over, before a fatal
+  message and when the application exits. Warnings and errors aren't held back.
+
+  Whether a kept message is written is decided by its category as the category
+  filter of Qt left it after the rules, including its default severity. A
+  message of a category which never went through the filter is written.
+ */
+EarlyLogBuffer::EarlyLogBuffer(int capacity)
+    : m_capacity(capacity)
+{
+}
+
+EarlyLogBuffer *EarlyLogBuffer::instance()
+{
+    return globalEarlyLogBuffer;
+}
+
+void EarlyLogBuffer::start(int timeout)
+{
+    static bool installed = false;
+    if (!installed) {
+        // Logger installs its handler when it's created, ours runs before it.
+        Logger::globalInstance();
+        previousHandler = qInstallMessageHandler(messageHandler);
+        // the filter sees every category now, and again whenever the rules change.
+        previousFilter = QLoggingCategory::installFilter(categoryFilter);
+        qAddPostRoutine(releaseEarlyLogBuffer);
+        installed = true;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_buffering = true;
+    m_deadline = timeout < 0 ? QDeadlineTimer(QDeadlineTimer::Forever) : QDeadlineTimer(timeout);
+}
+
+bool EarlyLogBuffer::isBuffering() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_buffering;
+}
+
+int EarlyLogBuffer::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.size();
+}
+
+bool EarlyLogBuffer::buffer(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_buffering)
+        return false;
+
+    // the failures at startup are seen at once.
+    if (type == QtWarningMsg || type == QtCriticalMsg)
+        return false;
+
+    if (type == QtFatalMsg || m_entries.size() >= m_capacity || m_deadline.hasExpired()) {
+        locker.unlock();
+        release();
+        return false;
+    }
+
+    m_entries.append(Entry{QDateTime::currentDateTime(), type, QByteArray(context.category ? context.category : "default"),
+                           QByteArray(context.file), context.line, QByteArray(context.function), message});
+    return true;
+}
+
+void EarlyLogBuffer::release()
+{
+    QVector<Entry> entries;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_buffering)
+            return;
+        m_buffering = false;
+        entries.swap(m_entries);
+    }
+
+    QHash<QByteArray, quint8> enabledTypes;
+    if (auto states = categoryStates()) {
+        QMutexLocker locker(&states->mutex);
+        enabledTypes = states->enabledTypes;
+    }
+
+    for (const Entry &entry : entries) {
+        // the category was enabled by the default rules when logging, check it against the current ones.
+        auto enabled = enabledTypes.constFind(entry.category);
+        if (enabled != enabledTypes.constEnd() && !(enabled.value() & typeBit(entry.type)))
+            continue;
+
+        Logger::globalInstance()->write(entry.time, levelOf(entry.type), entry.file.constData(), entry.line,
+                                        entry.function.constData(), entry.category.constData(), entry.message);
+    }
+}
+
+void EarlyLogBuffer::categoryFilter(QLoggingCategory *category)
+{
+    if (previousFilter)
+        previousFilter(category);
+
+    quint8 enabled = 0;
+    for (QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg}) {
+        if (category->isEnabled(type))
+            enabled |= typeBit(type);
+    }
+
+    if (auto states = categoryStates()) {
+        QMutexLocker locker(&states->mutex);
+        states->enabledTypes.insert(QByteArray(category->categoryName()), enabled);
+    }
+}
+
+void EarlyLogBuffer::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    if (instance()->buffer(type, context, message))
+        return;
+
+    if (previousHandler) {
+        previousHandler(type, context, message);
+    } else {
+        fprintf(stderr, "%s\n", qUtf8Printable(qFormatLogMessage(type, context, message)));
+        fflush(stderr);
+    }
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef EARLYLOGBUFFER_H
+#define EARLYLOGBUFFER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Keeps the Qt debug and info messages logged before the logging rules of
+ * DConfig are applied, release() writes the ones the rules enable to Logger
+ * with their original time. Logging doesn't wait for the rules, warnings and
+ * errors are written at once.
+ */
+class EarlyLogBuffer
+{
+    Q_DISABLE_COPY(EarlyLogBuffer)
+public:
+    explicit EarlyLogBuffer(int capacity = 1024);
+
+    static EarlyLogBuffer *instance();
+
+    // installs the message handler of instance() in front of the one of Logger and starts buffering.
+    // the first message logged after timeout msecs releases the buffer, whether an event loop runs or not.
+    void start(int timeout = -1);
+    bool isBuffering() const;
+    int size() const;
+    // stops buffering and writes the buffered messages which are enabled by the current rules.
+    void release();
+
+    // returns false if the message isn't buffered and has to be written now.
+    bool buffer(QtMsgType type, const QMessageLogContext &context, const QString &message);
+
+private:
+    struct Entry
+    {
+        QDateTime time;
+        QtMsgType type;
+        QByteArray category;
+        QByteArray file;
+        int line;
+        QByteArray function;
+        QString message;
+    };
+
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message);
+    static void categoryFilter(QLoggingCategory *category);
+
+    mutable QMutex m_mutex;
+    QVector<Entry> m_entries;
+    int m_capacity;
+    bool m_buffering = false;
+    QDeadlineTimer m_deadline;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // EARLYLOGBUFFER_H
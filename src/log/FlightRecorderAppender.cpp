@@ -0,0 +1,260 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "FlightRecorderAppender.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+DCORE_BEGIN_NAMESPACE
+
+// offsets in the file header.
+static constexpr int CapacityOffset = FlightRecorder::MagicSize + 1;
+static constexpr int WritePosOffset = 16;
+static constexpr int WriteEndOffset = 24;
+// size(u32) time(i64) level(u8) line(i32) 3 * length(u16) messageLength(u32)
+static constexpr int RecordHeaderSize = 4 + 8 + 1 + 4 + 3 * 2 + 4;
+static constexpr int RecordOverhead = RecordHeaderSize + 4;
+static constexpr int MinimumCapacity = 4096;
+
+static inline int boundedLength(const char *text, int limit)
+{
+    return text ? int(qstrnlen(text, uint(limit))) : 0;
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::FlightRecorderAppender
+
+  \brief FlightRecorderAppender keeps the last log records in a memory mapped ring file.
+
+  A record is copied into the shared mapping of the file and nothing else
+  happens when logging, there are no system calls. Because the pages belong
+  to the file, the records are still in the file after the process crashed,
+  use FlightRecorderReader or the dtk-log-decoder tool to read them.
+
+  An existing file with records, i.e. the one of the previous run, is renamed
+  with a `.1` suffix before the new ring is created. A single record takes up
+  to a quarter of \a capacity: the category, the file and the function get
+  up to a quarter of that each, and the message is truncated to the rest.
+ */
+FlightRecorderAppender::FlightRecorderAppender(const QString &fileName, int capacity)
+    : m_file(fileName)
+    , m_capacity(qMax(capacity, MinimumCapacity))
+{
+    if (!map())
+        qWarning("Can't map the flight recorder file \"%s\": %s", qPrintable(fileName), qPrintable(m_file.errorString()));
+}
+
+FlightRecorderAppender::~FlightRecorderAppender()
+{
+    if (m_header)
+        m_file.unmap(m_header);
+}
+
+bool FlightRecorderAppender::map()
+{
+    const QString &fileName = m_file.fileName();
+    if (FlightRecorderReader::isFlightRecorderFile(fileName)) {
+        FlightRecorderReader previous(fileName);
+        if (previous.open() && !previous.lastRecords(1).isEmpty()) {
+            const QString &backup = fileName + QStringLiteral(".1");
+            QFile::remove(backup);
+            QFile::rename(fileName, backup);
+        }
+    }
+
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)
+        || !m_file.resize(FlightRecorder::HeaderSize + m_capacity))
+        return false;
+
+    m_header = m_file.map(0, FlightRecorder::HeaderSize + m_capacity);
+    if (!m_header)
+        return false;
+    m_data = m_header + FlightRecorder::HeaderSize;
+
+    memset(m_header, 0, FlightRecorder::HeaderSize);
+    memcpy(m_header, FlightRecorder::Magic, FlightRecorder::MagicSize);
+    m_header[FlightRecorder::MagicSize] = FlightRecorder::Version;
+    qToLittleEndian<quint32>(quint32(m_capacity), m_header + CapacityOffset);
+    return true;
+}
+
+void FlightRecorderAppender::copy(quint64 pos, const void *data, int size)
+{
+    const int offset = int(pos % quint64(m_capacity));
+    const int first = qMin(size, m_capacity - offset);
+    memcpy(m_data + offset, data, size_t(first));
+    if (first < size)
+        memcpy(m_data, static_cast<const char *>(data) + first, size_t(size - first));
+}
+
+void FlightRecorderAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                                    const char *function, const QString &category, const QString &message)
+{
+    if (!m_data)
+        return;
+
+    // a record never overwrites itself, and the lengths fit into their fields.
+    const int recordLimit = m_capacity / 4 - RecordOverhead;
+    const int fieldLimit = qMin(recordLimit / 4, 0xffff);
+    const QByteArray &categoryUtf8 = category.toUtf8().left(fieldLimit);
+    const int fileLength = boundedLength(file, fieldLimit);
+    const int functionLength = boundedLength(function, fieldLimit);
+    QByteArray messageUtf8 = message.toUtf8();
+    const int messageLimit = recordLimit - categoryUtf8.size() - fileLength - functionLength;
+    if (messageUtf8.size() > messageLimit)
+        messageUtf8.truncate(messageLimit);
+
+    const quint32 size = quint32(RecordOverhead + categoryUtf8.size() + fileLength + functionLength + messageUtf8.size());
+    uchar head[RecordHeaderSize];
+    qToLittleEndian<quint32>(size, head);
+    qToLittleEndian<qint64>(time.toMSecsSinceEpoch(), head + 4);
+    head[12] = uchar(level);
+    qToLittleEndian<qint32>(line, head + 13);
+    qToLittleEndian<quint16>(quint16(categoryUtf8.size()), head + 17);
+    qToLittleEndian<quint16>(quint16(fileLength), head + 19);
+    qToLittleEndian<quint16>(quint16(functionLength), head + 21);
+    qToLittleEndian<quint32>(quint32(messageUtf8.size()), head + 23);
+
+    // the oldest bytes up to writeEnd may be overwritten from now on.
+    const quint64 writeEnd = m_writePos + size;
+    qToLittleEndian<quint64>(writeEnd, m_header + WriteEndOffset);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    quint64 pos = m_writePos;
+    copy(pos, head, RecordHeaderSize);
+    pos += RecordHeaderSize;
+    copy(pos, categoryUtf8.constData(), categoryUtf8.size());
+    pos += quint64(categoryUtf8.size());
+    copy(pos, file, fileLength);
+    pos += quint64(fileLength);
+    copy(pos, function, functionLength);
+    pos += quint64(functionLength);
+    copy(pos, messageUtf8.constData(), messageUtf8.size());
+    pos += quint64(messageUtf8.size());
+    copy(pos, head, 4);
+
+    // publish the record only after it's complete.
+    std::atomic_thread_fence(std::memory_order_release);
+    m_writePos = writeEnd;
+    qToLittleEndian<quint64>(m_writePos, m_header + WritePosOffset);
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::FlightRecorderReader
+
+  \brief FlightRecorderReader reads the records of a FlightRecorderAppender file.
+
+  Records which were partially overwritten by a write which didn't complete
+  are skipped.
+ */
+FlightRecorderReader::FlightRecorderReader(const QString &fileName)
+    : m_file(fileName)
+{
+}
+
+bool FlightRecorderReader::isFlightRecorderFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    return file.read(FlightRecorder::MagicSize) == QByteArray(FlightRecorder::Magic, FlightRecorder::MagicSize);
+}
+
+bool FlightRecorderReader::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    m_data = m_file.readAll();
+    const char *header = m_data.constData();
+    if (m_data.size() < FlightRecorder::HeaderSize
+        || memcmp(header, FlightRecorder::Magic, FlightRecorder::MagicSize) != 0
+        || quint8(header[FlightRecorder::MagicSize]) != FlightRecorder::Version) {
+        m_error = QStringLiteral("Not a flight recorder file");
+        return false;
+    }
+
+    m_capacity = qFromLittleEndian<quint32>(header + CapacityOffset);
+    m_writePos = qFromLittleEndian<quint64>(header + WritePosOffset);
+    m_writeEnd = qFromLittleEndian<quint64>(header + WriteEndOffset);
+    if (m_capacity == 0 || quint64(m_data.size()) < FlightRecorder::HeaderSize + quint64(m_capacity)
+        || m_writeEnd < m_writePos || m_writeEnd - m_writePos > m_capacity) {
+        m_error = QStringLiteral("The flight recorder file is damaged");
+        return false;
+    }
+
+    return true;
+}
+
+void FlightRecorderReader::read(quint64 pos, void *data, int size) const
+{
+    const char *ring = m_data.constData() + FlightRecorder::HeaderSize;
+    const int offset = int(pos % m_capacity);
+    const int first = qMin(size, int(m_capacity) - offset);
+    memcpy(data, ring + offset, size_t(first));
+    if (first < size)
+        memcpy(static_cast<char *>(data) + first, ring, size_t(size - first));
+}
+
+QVector<BinaryLog::Record> FlightRecorderReader::lastRecords(int count) const
+{
+    QVector<BinaryLog::Record> records;
+    if (m_capacity == 0)
+        return records;
+
+    // bytes before oldest are overwritten, by a complete record or by the one being written.
+    const quint64 oldest = m_writeEnd > m_capacity ? m_writeEnd - m_capacity : 0;
+    quint64 pos = m_writePos;
+
+    while ((count < 0 || records.size() < count) && pos - oldest >= quint64(RecordOverhead)) {
+        uchar tail[4];
+        read(pos - 4, tail, 4);
+        const quint32 size = qFromLittleEndian<quint32>(tail);
+        if (size < quint32(RecordOverhead) || size > pos - oldest)
+            break;
+
+        QByteArray bytes(int(size), Qt::Uninitialized);
+        read(pos - size, bytes.data(), int(size));
+        const uchar *head = reinterpret_cast<const uchar *>(bytes.constData());
+        const int categoryLength = qFromLittleEndian<quint16>(head + 17);
+        const int fileLength = qFromLittleEndian<quint16>(head + 19);
+        const int functionLength = qFromLittleEndian<quint16>(head + 21);
+        const quint32 messageLength = qFromLittleEndian<quint32>(head + 23);
+        if (qFromLittleEndian<quint32>(head) != size || head[12] > Logger::Fatal
+            || quint64(RecordOverhead) + categoryLength + fileLength + functionLength + messageLength != size)
+            break;
+
+        BinaryLog::Record record;
+        record.time = QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(head + 4));
+        record.level = static_cast<Logger::LogLevel>(head[12]);
+        record.line = qFromLittleEndian<qint32>(head + 13);
+        int offset = RecordHeaderSize;
+        record.category = QString::fromUtf8(bytes.constData() + offset, categoryLength);
+        offset += categoryLength;
+        record.file = bytes.mid(offset, fileLength);
+        offset += fileLength;
+        record.function = bytes.mid(offset, functionLength);
+        offset += functionLength;
+        record.message = QString::fromUtf8(bytes.constData() + offset, int(messageLength));
+        records.append(record);
+
+        pos -= size;
+    }
+
+    std::reverse(records.begin(), records.end());
+    return records;
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef FLIGHTRECORDERAPPENDER_H
+#define FLIGHTRECORDERAPPENDER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+
+#include <AbstractAppender.h>
+
+#include "BinaryAppender.h"
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Flight recorder file layout, integers are little endian.
+ *
+ *   header:  "DTKFREC" version(u8) capacity(u32) reserved(u32) writePos(u64) writeEnd(u64)
+ *   ring:    capacity bytes
+ *
+ * writePos and writeEnd count the bytes written since the file was created,
+ * the ring offset of a position is position % capacity. A record is written
+ * to [writePos, writeEnd) and writePos is moved to writeEnd when it's
+ * complete, so the bytes a crashed writer may have overwritten are known.
+ *
+ *   record:  size(u32) time(i64 msecs since epoch) level(u8) line(i32)
+ *            categoryLength(u16) fileLength(u16) functionLength(u16) messageLength(u32)
+ *            category file function message size(u32)
+ *
+ * The size is repeated at the end of a record, the reader walks backwards
+ * from writePos.
+ */
+namespace FlightRecorder {
+static constexpr char Magic[] = "DTKFREC";
+static constexpr int MagicSize = 7;
+static constexpr quint8 Version = 1;
+static constexpr int HeaderSize = 32;
+}
+
+/*
+ * Writes the records into a memory mapped ring file, the oldest records are
+ * overwritten when the ring is full. Logging only copies the record into the
+ * mapping, the kernel writes the pages back to the file, also after the
+ * process crashed.
+ */
+class FlightRecorderAppender : public AbstractAppender
+{
+    Q_DISABLE_COPY(FlightRecorderAppender)
+public:
+    explicit FlightRecorderAppender(const QString &fileName, int capacity = 4 * 1024 * 1024);
+    ~FlightRecorderAppender() override;
+
+    QString fileName() const { return m_file.fileName(); }
+    int capacity() const { return m_capacity; }
+    bool isMapped() const { return m_data; }
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *function, const QString &category, const QString &message) override;
+
+private:
+    bool map();
+    void copy(quint64 pos, const void *data, int size);
+
+    QFile m_file;
+    int m_capacity;
+    uchar *m_header = nullptr;
+    uchar *m_data = nullptr;
+    quint64 m_writePos = 0;
+};
+
+/*
+ * Reads the last records of a flight recorder file, usually the one of a
+ * process which crashed.
+ */
+class FlightRecorderReader
+{
+public:
+    explicit FlightRecorderReader(const QString &fileName);
+
+    static bool isFlightRecorderFile(const QString &fileName);
+
+    bool open();
+    QString errorString() const { return m_error; }
+    // the last count records, the oldest first. count < 0 returns all records.
+    QVector<BinaryLog::Record> lastRecords(int count = -1) const;
+
+private:
+    void read(quint64 pos, void *data, int size) const;
+
+    QFile m_file;
+    QByteArray m_data;
+    quint32 m_capacity = 0;
+    quint64 m_writePos = 0;
+    quint64 m_writeEnd = 0;
+    QString m_error;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // FLIGHTRECORDERAPPENDER_H
@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "LogCompressor.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QtEndian>
+
+#include <algorithm>
+#include <array>
+
+DCORE_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(LogCompressor, globalLogCompressor)
+
+static const QString CompressedSuffix = QStringLiteral(".gz");
+
+static quint32 crc32(const QByteArray &data)
+{
+    static const auto table = [] {
+        std::array<quint32, 256> table{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    quint32 crc = 0xffffffffu;
+    for (const char byte : data)
+        crc = table[(crc ^ quint8(byte)) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+class CompressRunnable : public QRunnable
+{
+public:
+    CompressRunnable(const QString &logFileName, qint64 diskBudget)
+        : m_logFileName(logFileName)
+        , m_diskBudget(diskBudget)
+    {
+    }
+
+    void run() override { LogCompressor::compressNow(m_logFileName, m_diskBudget); }
+
+private:
+    QString m_logFileName;
+    qint64 m_diskBudget;
+};
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::LogCompressor
+
+  \brief LogCompressor compresses rotated log files in a background thread.
+
+  The files are written as gzip, so the usual tools can read them. Qt only
+  offers the zlib format with qCompress(), its deflate stream is wrapped into
+  a gzip member instead of adding a dependency on zlib. Large files are
+  compressed in chunks, gzip readers decompress the concatenated members as
+  one stream.
+ */
+LogCompressor::LogCompressor()
+{
+    // one file at a time, in the order of the rotations.
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(10 * 1000);
+}
+
+LogCompressor::~LogCompressor()
+{
+    m_pool.waitForDone();
+}
+
+LogCompressor *LogCompressor::instance()
+{
+    return globalLogCompressor;
+}
+
+QByteArray LogCompressor::gzip(const QByteArray &data, int compressionLevel)
+{
+    // qCompress(): size(u32 be) zlib header(2) deflate adler32(4)
+    const QByteArray &zlib = qCompress(data, compressionLevel);
+    if (zlib.size() < 4 + 2 + 4)
+        return QByteArray();
+
+    QByteArray result;
+    result.reserve(zlib.size() + 12);
+    // magic, deflate, no flags, no time, no extra flags, unknown OS.
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    result.append(header, sizeof(header));
+    result.append(zlib.constData() + 6, zlib.size() - 6 - 4);
+
+    char trailer[8];
+    qToLittleEndian<quint32>(crc32(data), trailer);
+    qToLittleEndian<quint32>(quint32(data.size()), trailer + 4);
+    result.append(trailer, sizeof(trailer));
+    return result;
+}
+
+bool LogCompressor::gzipFile(QIODevice *source, QIODevice *target, int chunkSize)
+{
+    while (!source->atEnd()) {
+        const QByteArray &chunk = source->read(chunkSize);
+        if (chunk.isEmpty())
+            return false;
+
+        const QByteArray &member = gzip(chunk);
+        if (member.isEmpty() || target->write(member) != member.size())
+            return false;
+    }
+    return true;
+}
+
+void LogCompressor::compressRotatedFiles(const QString &logFileName, qint64 diskBudget)
+{
+    m_pool.start(new CompressRunnable(logFileName, diskBudget));
+}
+
+bool LogCompressor::waitForDone(int msecs)
+{
+    return m_pool.waitForDone(msecs);
+}
+
+void LogCompressor::compressNow(const QString &logFileName, qint64 diskBudget)
+{
+    const QFileInfo logFile(logFileName);
+    QDir dir(logFile.absolutePath());
+    const QString &prefix = logFile.fileName() + QLatin1Char('.');
+    const QFileInfoList &files = dir.entryInfoList({prefix + QLatin1Char('*')}, QDir::Files);
+
+    QFileInfoList compressed;
+    for (const QFileInfo &file : files) {
+        if (file.fileName().endsWith(CompressedSuffix)) {
+            compressed.append(file);
+            continue;
+        }
+        // an unfinished file of an earlier compression.
+        if (file.fileName().endsWith(CompressedSuffix + QStringLiteral(".tmp"))) {
+            QFile::remove(file.absoluteFilePath());
+            continue;
+        }
+
+        QFile source(file.absoluteFilePath());
+        if (source.size() == 0 || !source.open(QIODevice::ReadOnly))
+            continue;
+
+        const QString &target = file.absoluteFilePath() + CompressedSuffix;
+        QFile temporary(target + QStringLiteral(".tmp"));
+        if (!temporary.open(QIODevice::WriteOnly | QIODevice::Truncate) || !gzipFile(&source, &temporary)) {
+            temporary.remove();
+            continue;
+        }
+        source.close();
+        // the budget keeps the newest files, by the time they were written.
+        temporary.flush();
+        temporary.setFileTime(file.lastModified(), QFileDevice::FileModificationTime);
+        temporary.close();
+        QFile::remove(target);
+        if (temporary.rename(target)) {
+            source.remove();
+            compressed.append(QFileInfo(target));
+        }
+    }
+
+    if (diskBudget <= 0)
+        return;
+
+    // the newest files are kept.
+    std::sort(compressed.begin(), compressed.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() > b.lastModified();
+    });
+    qint64 total = 0;
+    for (const QFileInfo &file : compressed) {
+        total += file.size();
+        if (total > diskBudget)
+            QFile::remove(file.absoluteFilePath());
+    }
+}
+
+DCORE_END_NAMESPACE
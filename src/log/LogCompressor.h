@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef LOGCOMPRESSOR_H
+#define LOGCOMPRESSOR_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QThreadPool>
+
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Compresses the rotated files of a log file with gzip and removes the
+ * oldest compressed files over the disk budget, in a background thread.
+ * The rotated files are the files named `<log file>.<suffix>`.
+ */
+class LogCompressor
+{
+    Q_DISABLE_COPY(LogCompressor)
+public:
+    LogCompressor();
+    ~LogCompressor();
+
+    static LogCompressor *instance();
+
+    // a gzip member made of the deflate stream of qCompress().
+    static QByteArray gzip(const QByteArray &data, int compressionLevel = -1);
+    // compresses the file chunk by chunk, a gzip member per chunk, so that the
+    // memory used doesn't depend on the size of the file.
+    static bool gzipFile(QIODevice *source, QIODevice *target, int chunkSize = 16 * 1024 * 1024);
+
+    // returns immediately, the files are processed one log file after another.
+    void compressRotatedFiles(const QString &logFileName, qint64 diskBudget);
+    bool waitForDone(int msecs = -1);
+
+    // the blocking work of compressRotatedFiles().
+    static void compressNow(const QString &logFileName, qint64 diskBudget);
+
+private:
+    QThreadPool m_pool;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // LOGCOMPRESSOR_H
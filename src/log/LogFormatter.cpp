@@ -0,0 +1,414 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "LogFormatter.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+
+#include <AbstractStringAppender.h>
+
+#include "LogCompressor.h"
+#include "LogMetrics.h"
+
+DCORE_BEGIN_NAMESPACE
+
+// the default time format of %{time}.
+static const QString DefaultTimeFormat = QStringLiteral("HH:mm:ss.zzz");
+// cached file and function names, the cache is cleared when it's full.
+static constexpr int NameCacheLimit = 512;
+
+static inline QString padded(const QString &string, int width)
+{
+    if (width > 0)
+        return string.rightJustified(width);
+    if (width < 0)
+        return string.leftJustified(-width);
+    return string;
+}
+
+/*
+ * Formats the fields LogFormatter doesn't implement itself, the elapsed
+ * times of %{time}{process} and %{time}{boot}, with AbstractStringAppender.
+ */
+class LogFieldAppender : public AbstractStringAppender
+{
+public:
+    explicit LogFieldAppender(const QString &format)
+    {
+        setFormat(format);
+    }
+
+    QString formatted(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                      const char *function, const QString &category, const QString &message) const
+    {
+        return formattedString(time, level, file, line, function, category, message);
+    }
+
+protected:
+    void append(const QDateTime &, Logger::LogLevel, const char *, int,
+                const char *, const QString &, const QString &) override {}
+};
+
+static inline qint64 floorDiv(qint64 value, qint64 divisor)
+{
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::LogFormatter
+
+  \brief LogFormatter formats log records with the same format as
+  AbstractStringAppender::setFormat(), the format is parsed once.
+
+  The padding of the level names is resolved when parsing, and the time is
+  formatted once per second: the part before and after the milliseconds
+  (`zzz`) is cached, only the milliseconds are formatted for every record.
+ */
+LogFormatter::LogFormatter(const QString &format)
+{
+    setFormat(format);
+}
+
+void LogFormatter::setFormat(const QString &format)
+{
+    m_format = format;
+    m_fields.clear();
+
+    auto appendLiteral = [this](const QString &text) {
+        if (text.isEmpty())
+            return;
+        if (!m_fields.isEmpty() && m_fields.last().type == Literal) {
+            m_fields.last().text.append(text);
+            return;
+        }
+        Field field;
+        field.text = text;
+        m_fields.append(field);
+    };
+
+    int i = 0;
+    const int size = format.size();
+    while (i < size) {
+        const QChar c = format.at(i);
+        if (c != QLatin1Char('%') || i + 1 >= size) {
+            appendLiteral(c);
+            ++i;
+            continue;
+        }
+
+        const QChar next = format.at(i + 1);
+        if (next == QLatin1Char('%')) {
+            appendLiteral(next);
+            i += 2;
+            continue;
+        }
+
+        const int end = next == QLatin1Char('{') ? format.indexOf(QLatin1Char('}'), i + 2) : -1;
+        if (end < 0) {
+            appendLiteral(c);
+            ++i;
+            continue;
+        }
+
+        const QString token = format.mid(i, end - i + 1);
+        QString command = format.mid(i + 2, end - i - 2);
+        i = end + 1;
+
+        Field field;
+        const int colon = command.indexOf(QLatin1Char(':'));
+        if (colon >= 0) {
+            field.width = command.mid(colon + 1).toInt();
+            command.truncate(colon);
+        }
+
+        if (command == QLatin1String("time")) {
+            field.type = Time;
+            field.text = DefaultTimeFormat;
+            if (i < size && format.at(i) == QLatin1Char('{')) {
+                const int timeEnd = format.indexOf(QLatin1Char('}'), i + 1);
+                if (timeEnd >= 0) {
+                    field.text = format.mid(i + 1, timeEnd - i - 1);
+                    i = timeEnd + 1;
+                }
+            }
+
+            // elapsed times, not date formats.
+            if (field.text == QLatin1String("process") || field.text == QLatin1String("boot")) {
+                field.type = Fallback;
+                field.appender = std::make_shared<LogFieldAppender>(token + QLatin1Char('{') + field.text + QLatin1Char('}'));
+                m_fields.append(field);
+                continue;
+            }
+
+            // quoted text may contain `z`, don't try to split it.
+            const int zPos = field.text.indexOf(QLatin1Char('z'));
+            const int zCount = field.text.count(QLatin1Char('z'));
+            if (field.text.contains(QLatin1Char('\''))) {
+                field.timeMode = Uncached;
+            } else if (zCount == 0) {
+                field.timeMode = CachedSecond;
+            } else if (zCount == 3 && field.text.mid(zPos, 3) == QLatin1String("zzz")) {
+                field.timeMode = CachedMsec;
+                field.timePrefixFormat = field.text.left(zPos);
+                field.timeSuffixFormat = field.text.mid(zPos + 3);
+            } else {
+                field.timeMode = Uncached;
+            }
+        } else if (command.compare(QLatin1String("type"), Qt::CaseInsensitive) == 0
+                   || command.compare(QLatin1String("typeOne"), Qt::CaseInsensitive) == 0) {
+            field.type = Type;
+            const bool upper = command.at(0).isUpper();
+            const bool one = command.size() > 4;
+            for (int level = Logger::Trace; level <= Logger::Fatal; ++level) {
+                QString name = Logger::levelToString(static_cast<Logger::LogLevel>(level));
+                if (one)
+                    name = name.left(1);
+                name = upper ? name.toUpper() : (one ? name.toLower() : name);
+                field.levels.append(padded(name, field.width));
+            }
+        } else if (command == QLatin1String("File")) {
+            field.type = FullFile;
+        } else if (command == QLatin1String("file")) {
+            field.type = File;
+        } else if (command == QLatin1String("line")) {
+            field.type = Line;
+        } else if (command == QLatin1String("Function")) {
+            field.type = FullFunction;
+        } else if (command == QLatin1String("function")) {
+            field.type = Function;
+        } else if (command == QLatin1String("message")) {
+            field.type = Message;
+        } else if (command == QLatin1String("category")) {
+            field.type = Category;
+        } else if (command == QLatin1String("appname")) {
+            field.type = AppName;
+        } else if (command == QLatin1String("pid")) {
+            field.type = Pid;
+        } else if (command == QLatin1String("threadid")) {
+            field.type = ThreadId;
+        } else if (command == QLatin1String("qthreadptr")) {
+            field.type = QThreadPtr;
+        } else {
+            // unknown commands are kept as they are.
+            appendLiteral(token);
+            continue;
+        }
+
+        m_fields.append(field);
+    }
+}
+
+void LogFormatter::appendTime(QString &result, const Field &field, const QDateTime &time) const
+{
+    if (field.timeMode == Uncached) {
+        result.append(padded(time.toString(field.text), field.width));
+        return;
+    }
+
+    const qint64 msecs = time.toMSecsSinceEpoch();
+    const qint64 second = floorDiv(msecs, 1000);
+    if (second != field.cachedSecond || time.timeSpec() != field.cachedSpec) {
+        if (field.timeMode == CachedSecond) {
+            field.cachedPrefix = time.toString(field.text);
+        } else {
+            field.cachedPrefix = field.timePrefixFormat.isEmpty() ? QString() : time.toString(field.timePrefixFormat);
+            field.cachedSuffix = field.timeSuffixFormat.isEmpty() ? QString() : time.toString(field.timeSuffixFormat);
+        }
+        field.cachedSecond = second;
+        field.cachedSpec = time.timeSpec();
+    }
+
+    if (field.timeMode == CachedSecond) {
+        result.append(padded(field.cachedPrefix, field.width));
+        return;
+    }
+
+    const int msec = int(msecs - second * 1000);
+    const QChar digits[3] = {QLatin1Char(char('0' + msec / 100)),
+                             QLatin1Char(char('0' + msec / 10 % 10)),
+                             QLatin1Char(char('0' + msec % 10))};
+    if (field.width == 0) {
+        result.append(field.cachedPrefix);
+        result.append(digits, 3);
+        result.append(field.cachedSuffix);
+        return;
+    }
+
+    QString text;
+    text.reserve(field.cachedPrefix.size() + 3 + field.cachedSuffix.size());
+    text.append(field.cachedPrefix);
+    text.append(digits, 3);
+    text.append(field.cachedSuffix);
+    result.append(padded(text, field.width));
+}
+
+QString LogFormatter::cachedName(NameCache &cache, const char *source, FieldType type) const
+{
+    if (!source)
+        return QString();
+
+    auto it = cache.find(source);
+    // the address may be reused by a different string which isn't a literal.
+    if (it != cache.end() && qstrcmp(it->source.constData(), source) == 0)
+        return it->name;
+
+    if (cache.size() >= NameCacheLimit)
+        cache.clear();
+
+    CachedName name;
+    name.source = QByteArray(source);
+    if (type == Function) {
+        name.name = AbstractStringAppender::stripFunctionName(source);
+    } else {
+        const int slash = qMax(name.source.lastIndexOf('/'), name.source.lastIndexOf('\\'));
+        name.name = QString::fromUtf8(name.source.mid(slash + 1));
+    }
+    return cache.insert(source, name)->name;
+}
+
+QString LogFormatter::formatted(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                                const char *function, const QString &category, const QString &message) const
+{
+    QString result;
+    result.reserve(128 + message.size());
+
+    for (const Field &field : m_fields) {
+        switch (field.type) {
+        case Literal:
+            result.append(field.text);
+            break;
+        case Time:
+            appendTime(result, field, time);
+            break;
+        case Type:
+            result.append(field.levels.value(level));
+            break;
+        case File:
+            result.append(padded(cachedName(m_fileNames, file, File), field.width));
+            break;
+        case FullFile:
+            result.append(padded(QString::fromUtf8(file), field.width));
+            break;
+        case Line:
+            result.append(padded(QString::number(line), field.width));
+            break;
+        case Function:
+            result.append(padded(cachedName(m_functionNames, function, Function), field.width));
+            break;
+        case FullFunction:
+            result.append(padded(QString::fromUtf8(function), field.width));
+            break;
+        case Message:
+            result.append(padded(message, field.width));
+            break;
+        case Category:
+            result.append(padded(category, field.width));
+            break;
+        case AppName:
+            result.append(padded(QCoreApplication::applicationName(), field.width));
+            break;
+        case Pid:
+            result.append(padded(QString::number(QCoreApplication::applicationPid()), field.width));
+            break;
+        case ThreadId:
+            result.append(padded(QLatin1String("0x") + QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()), 16),
+                                 field.width));
+            break;
+        case QThreadPtr:
+            result.append(padded(QLatin1String("0x") + QString::number(reinterpret_cast<quintptr>(QThread::currentThread()), 16),
+                                 field.width));
+            break;
+        case Fallback: {
+            QString text = field.appender->formatted(time, level, file, line, function, category, message);
+            // the line break of AbstractStringAppender::setFormat().
+            if (text.endsWith(QLatin1Char('\n')))
+                text.chop(1);
+            result.append(text);
+            break;
+        }
+        }
+    }
+
+    return result;
+}
+
+FormattedRollingFileAppender::FormattedRollingFileAppender(const QString &fileName, const QString &format)
+    : RollingFileAppender(fileName)
+{
+    setLogFormat(format);
+}
+
+void FormattedRollingFileAppender::setLogFormat(const QString &format)
+{
+    m_logFormat = format;
+    // keep the line break handling of the base appender for formats ending with a new line.
+    if (format.endsWith(QLatin1Char('\n'))) {
+        m_formatter.setFormat(format.left(format.size() - 1));
+        setFormat(QStringLiteral("%{message}\n"));
+        m_lineBreakSize = 1;
+    } else {
+        m_formatter.setFormat(format);
+        setFormat(QStringLiteral("%{message}"));
+        m_lineBreakSize = 0;
+    }
+}
+
+void FormattedRollingFileAppender::setMaxFileSize(qint64 size)
+{
+    m_maxFileSize = qMax<qint64>(size, 0);
+    m_fileSize = -1;
+    // the rotated files left by an earlier run.
+    if (m_maxFileSize > 0)
+        LogCompressor::instance()->compressRotatedFiles(fileName(), m_diskBudget);
+}
+
+void FormattedRollingFileAppender::setDiskBudget(qint64 size)
+{
+    m_diskBudget = qMax<qint64>(size, 0);
+}
+
+void FormattedRollingFileAppender::rotateBySize()
+{
+    const QString &name = fileName();
+    const QString &base = name + QLatin1Char('.') + QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss-zzz"));
+    QString rotated = base;
+    for (int i = 1; QFile::exists(rotated) || QFile::exists(rotated + QStringLiteral(".gz")); ++i)
+        rotated = base + QLatin1Char('-') + QString::number(i);
+    if (!QFile::rename(name, rotated))
+        return;
+
+    // closes the rotated file, the next record opens a new one.
+    setFileName(name);
+    m_fileSize = 0;
+    // never wait for the compression in the logging thread.
+    LogCompressor::instance()->compressRotatedFiles(name, m_diskBudget);
+}
+
+void FormattedRollingFileAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                                          const char *function, const QString &category, const QString &message)
+{
+    const QString &formatted = m_formatter.formatted(time, level, file, line, function, category, message);
+    RollingFileAppender::append(time, level, file, line, function, category, formatted);
+
+    if (m_maxFileSize <= 0)
+        return;
+
+    if (m_fileSize < 0)
+        m_fileSize = QFileInfo(fileName()).size();
+    m_fileSize += qint64(LogMetrics::utf8Size(formatted)) + m_lineBreakSize;
+    if (m_fileSize < m_maxFileSize)
+        return;
+
+    // the daily rollover may have started a new file meanwhile.
+    m_fileSize = QFileInfo(fileName()).size();
+    if (m_fileSize >= m_maxFileSize)
+        rotateBySize();
+}
+
+DCORE_END_NAMESPACE
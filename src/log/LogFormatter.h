@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef LOGFORMATTER_H
+#define LOGFORMATTER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+#include <Logger.h>
+#include <RollingFileAppender.h>
+
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+class LogFieldAppender;
+
+/*
+ * A log format of AbstractStringAppender::setFormat() parsed once into a list
+ * of fields. Not thread safe, every appender owns its formatter and
+ * AbstractAppender::write() serializes the calls.
+ */
+class LogFormatter
+{
+public:
+    explicit LogFormatter(const QString &format = QString());
+
+    QString format() const { return m_format; }
+    void setFormat(const QString &format);
+
+    QString formatted(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                      const char *function, const QString &category, const QString &message) const;
+
+private:
+    enum FieldType {
+        Literal,
+        Time,
+        Type,
+        File,
+        FullFile,
+        Line,
+        Function,
+        FullFunction,
+        Message,
+        Category,
+        AppName,
+        Pid,
+        ThreadId,
+        QThreadPtr,
+        // formatted by AbstractStringAppender, like %{time}{process}.
+        Fallback
+    };
+
+    enum TimeMode {
+        Uncached,       // formatted for every record
+        CachedSecond,   // no sub-second part, formatted once per second
+        CachedMsec      // prefix and suffix of `zzz` formatted once per second
+    };
+
+    struct Field
+    {
+        FieldType type = Literal;
+        int width = 0;
+        // literal text, or the time format.
+        QString text;
+        // the level names with padding, for Type.
+        QVector<QString> levels;
+
+        TimeMode timeMode = Uncached;
+        QString timePrefixFormat;
+        QString timeSuffixFormat;
+        mutable qint64 cachedSecond = -1;
+        mutable Qt::TimeSpec cachedSpec = Qt::LocalTime;
+        mutable QString cachedPrefix;
+        mutable QString cachedSuffix;
+
+        // for Fallback, formats the field only.
+        std::shared_ptr<LogFieldAppender> appender;
+    };
+
+    struct CachedName
+    {
+        QByteArray source;
+        QString name;
+    };
+    // __FILE__ and Q_FUNC_INFO are literals, their address identifies them.
+    using NameCache = QHash<const char *, CachedName>;
+
+    void appendTime(QString &result, const Field &field, const QDateTime &time) const;
+    QString cachedName(NameCache &cache, const char *source, FieldType type) const;
+
+    QString m_format;
+    QVector<Field> m_fields;
+    mutable NameCache m_fileNames;
+    mutable NameCache m_functionNames;
+};
+
+/*
+ * RollingFileAppender which formats the records with a LogFormatter, the base
+ * appender only writes the formatted line. With a maximum file size the file
+ * is also rotated by size, the rotated files are compressed by LogCompressor.
+ */
+class FormattedRollingFileAppender : public RollingFileAppender
+{
+public:
+    explicit FormattedRollingFileAppender(const QString &fileName, const QString &format);
+
+    QString logFormat() const { return m_logFormat; }
+    void setLogFormat(const QString &format);
+
+    qint64 maxFileSize() const { return m_maxFileSize; }
+    // 0 disables the rotation by size and the compression.
+    void setMaxFileSize(qint64 size);
+    qint64 diskBudget() const { return m_diskBudget; }
+    // the size of the compressed files which are kept, 0 keeps all of them.
+    void setDiskBudget(qint64 size);
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *function, const QString &category, const QString &message) override;
+
+private:
+    void rotateBySize();
+
+    QString m_logFormat;
+    LogFormatter m_formatter;
+    int m_lineBreakSize = 0;
+    qint64 m_maxFileSize = 0;
+    qint64 m_diskBudget = 0;
+    // the bytes written, the file is only checked when it may be over the limit.
+    qint64 m_fileSize = -1;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // LOGFORMATTER_H
@@ -8,6 +8,13 @@
 #include <Logger.h>
 #include <ConsoleAppender.h>
 #include <RollingFileAppender.h>
+#include "AsyncAppender.h"
+#include "BinaryAppender.h"
+#include "FlightRecorderAppender.h"
+#include "EarlyLogBuffer.h"
+#include "LogFormatter.h"
+#include "LogMetrics.h"
+#include "LoggingRules.h"
 #if defined(BUILD_WITH_SYSTEMD) && defined(Q_OS_LINUX)
 #include <JournalAppender.h>
 #endif
@@ -17,7 +24,9 @@
 #include <unistd.h>
 #endif
 
+#include "dconfig.h"
 #include "dstandardpaths.h"
+#include "dexportedinterface.h"
 #include "dconfig_org_deepin_dtk_preference.hpp"
 
 DCORE_BEGIN_NAMESPACE
@@ -38,6 +47,9 @@ static void appendOrganizationAndApp(QString &path)
 #endif
 }
 
+// the early messages are written with the default rules if DConfig doesn't answer in time.
+static constexpr int EarlyLogTimeout = 3000;
+
 #define DEFAULT_FMT "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}"
 
 class DLogManagerPrivate {
@@ -50,19 +62,36 @@ public:
 
     dconfig_org_deepin_dtk_preference *createDConfig(const QString &appId);
     void initLoggingRules();
+    void createLoggingRulesConfigs(const QString &dsgAppId);
+    void scheduleLoggingRulesUpdate();
     void updateLoggingRules();
+    void releaseEarlyMessagesIfSettled();
 
     bool shouldSkipConsoleAppender() const;
+    void registerAppender(const QString &name, AbstractAppender *appender);
+    void unregisterAppender(AbstractAppender *appender);
 
     QString m_format;
     QString m_logPath;
+    qint64 m_maxLogFileSize = 0;
+    qint64 m_logFilesDiskBudget = 0;
     ConsoleAppender* m_consoleAppender = nullptr;
-    RollingFileAppender* m_rollingFileAppender = nullptr;
+    FormattedRollingFileAppender* m_rollingFileAppender = nullptr;
+    AsyncAppender* m_asyncFileAppender = nullptr;
+    BinaryAppender* m_binaryFileAppender = nullptr;
+    FlightRecorderAppender* m_flightRecorderAppender = nullptr;
 #if defined(BUILD_WITH_SYSTEMD) && defined(Q_OS_LINUX)
     JournalAppender* m_journalAppender = nullptr;
 #endif
+    // the registered appenders are wrapped to count their records.
+    QHash<AbstractAppender *, InstrumentedAppender *> m_instrumentedAppenders;
+    CategoryMetricsAppender *m_categoryMetricsAppender = nullptr;
     QScopedPointer<dconfig_org_deepin_dtk_preference> m_dsgConfig;
     QScopedPointer<dconfig_org_deepin_dtk_preference> m_fallbackConfig;
+    // receives the asynchronous steps of initLoggingRules() in the thread which created DLogManager.
+    QObject m_context;
+    LoggingRules m_loggingRules;
+    bool m_loggingRulesUpdatePending = false;
 
     DLogManager *q_ptr = nullptr;
     Q_DECLARE_PUBLIC(DLogManager)
@@ -76,7 +105,7 @@ dconfig_org_deepin_dtk_preference *DLogManagerPrivate::createDConfig(const QStri
 
     auto config = dconfig_org_deepin_dtk_preference::create(appId);
     QObject::connect(config, &dconfig_org_deepin_dtk_preference::rulesChanged,
-                     config, [this](){ updateLoggingRules(); });
+                     config, [this](){ scheduleLoggingRulesUpdate(); });
 
     return config;
 }
@@ -86,17 +115,39 @@ void DLogManagerPrivate::initLoggingRules()
     if (qEnvironmentVariableIsSet("DTK_DISABLED_LOGGING_RULES") || qEnvironmentVariableIsSet("QT_LOGGING_RULES"))
         return;
 
+    // keep the messages logged until the rules are applied, without blocking the logging threads.
+    // the rules are applied by the event loop, without an application nothing would release them.
+    if (QCoreApplication::instance()) {
+        // the deadline releases them in tools which never run the event loop.
+        EarlyLogBuffer::instance()->start(EarlyLogTimeout);
+        QTimer::singleShot(EarlyLogTimeout, &m_context, [] { EarlyLogBuffer::instance()->release(); });
+    }
+
+    // DSGApplication::id() may read /proc and ask the application manager over D-Bus.
+    auto worker = new QObject;
+    worker->moveToThread(DConfig::globalThread());
+    QMetaObject::invokeMethod(worker, [this, worker] {
+        delete worker;
+        const QString dsgAppId = DSGApplication::id();
+        QMetaObject::invokeMethod(&m_context, [this, dsgAppId] {
+            createLoggingRulesConfigs(dsgAppId);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void DLogManagerPrivate::createLoggingRulesConfigs(const QString &dsgAppId)
+{
     // 1. 未指定 fallbackId 时，以 dsgAppId 为准
-    QString dsgAppId = DSGApplication::id();
     m_dsgConfig.reset(createDConfig(dsgAppId));
 
     if (m_dsgConfig) {
         QObject::connect(m_dsgConfig.data(), &dconfig_org_deepin_dtk_preference::configInitializeSucceed,
-                         m_dsgConfig.data(), [this](){ updateLoggingRules(); });
+                         m_dsgConfig.data(), [this](){ scheduleLoggingRulesUpdate(); });
         QObject::connect(m_dsgConfig.data(), &dconfig_org_deepin_dtk_preference::configInitializeFailed,
                          m_dsgConfig.data(), [this, dsgAppId] {
                              m_dsgConfig.reset();
                              qWarning() << "Logging rules config is invalid, please check `appId` [" << dsgAppId << "]arg is correct";
+                             releaseEarlyMessagesIfSettled();
                          });
     }
 
@@ -108,13 +159,39 @@ void DLogManagerPrivate::initLoggingRules()
             // 3. 默认值和非默认值时，非默认值优先
     if (m_fallbackConfig) {
         QObject::connect(m_fallbackConfig.data(), &dconfig_org_deepin_dtk_preference::configInitializeSucceed,
-                         m_fallbackConfig.data(), [this](){ updateLoggingRules(); });
+                         m_fallbackConfig.data(), [this](){ scheduleLoggingRulesUpdate(); });
         QObject::connect(m_fallbackConfig.data(), &dconfig_org_deepin_dtk_preference::configInitializeFailed,
                          m_fallbackConfig.data(), [this, fallbackId] {
                              m_fallbackConfig.reset();
                              qWarning() << "Logging rules config is invalid, please check `appId` [" << fallbackId << "]arg is correct";
+                             releaseEarlyMessagesIfSettled();
                          });
     }
+
+    releaseEarlyMessagesIfSettled();
+}
+
+void DLogManagerPrivate::releaseEarlyMessagesIfSettled()
+{
+    // wait for the configs which are still loading and for a queued update, their rules apply to the early messages.
+    if ((m_dsgConfig && m_dsgConfig->isInitializing()) || (m_fallbackConfig && m_fallbackConfig->isInitializing())
+        || m_loggingRulesUpdatePending)
+        return;
+
+    EarlyLogBuffer::instance()->release();
+}
+
+void DLogManagerPrivate::scheduleLoggingRulesUpdate()
+{
+    // both configs may change or finish loading in the same event loop iteration, update once.
+    if (m_loggingRulesUpdatePending)
+        return;
+
+    m_loggingRulesUpdatePending = true;
+    QMetaObject::invokeMethod(&m_context, [this] {
+        m_loggingRulesUpdatePending = false;
+        updateLoggingRules();
+    }, Qt::QueuedConnection);
 }
 
 void DLogManagerPrivate::updateLoggingRules()
@@ -129,8 +206,34 @@ void DLogManagerPrivate::updateLoggingRules()
         var = m_dsgConfig->rules();
     }
 
+    // unchanged rules aren't applied again, see LoggingRules.
     if (var.isValid())
-        QLoggingCategory::setFilterRules(var.toString().replace(";", "\n"));
+        m_loggingRules.apply(var.toString());
+
+    releaseEarlyMessagesIfSettled();
+}
+
+void DLogManagerPrivate::registerAppender(const QString &name, AbstractAppender *appender)
+{
+    if (!m_categoryMetricsAppender) {
+        m_categoryMetricsAppender = new CategoryMetricsAppender;
+        dlogger->registerAppender(m_categoryMetricsAppender);
+    }
+
+    auto instrumented = new InstrumentedAppender(name, appender);
+    m_instrumentedAppenders.insert(appender, instrumented);
+    dlogger->registerAppender(instrumented);
+}
+
+void DLogManagerPrivate::unregisterAppender(AbstractAppender *appender)
+{
+    InstrumentedAppender *instrumented = m_instrumentedAppenders.take(appender);
+    if (!instrumented)
+        return;
+
+    dlogger->unregisterAppender(instrumented);
+    // deletes the appender too.
+    delete instrumented;
 }
 
 bool DLogManagerPrivate::shouldSkipConsoleAppender() const
@@ -189,16 +292,79 @@ void DLogManager::initConsoleAppender(){
     
     d->m_consoleAppender = new ConsoleAppender;
     d->m_consoleAppender->setFormat(d->m_format);
-    dlogger->registerAppender(d->m_consoleAppender);
+    d->registerAppender(QStringLiteral("console"), d->m_consoleAppender);
 }
 
 void DLogManager::initRollingFileAppender(){
     Q_D(DLogManager);
-    d->m_rollingFileAppender = new RollingFileAppender(getlogFilePath());
-    d->m_rollingFileAppender->setFormat(d->m_format);
+    // the async appender writes the same file.
+    if (d->m_asyncFileAppender) {
+        qWarning() << "the async file appender is registered already, the file appender isn't registered";
+        return;
+    }
+    d->m_rollingFileAppender = new FormattedRollingFileAppender(getlogFilePath(), d->m_format);
     d->m_rollingFileAppender->setLogFilesLimit(5);
     d->m_rollingFileAppender->setDatePattern(RollingFileAppender::DailyRollover);
-    dlogger->registerAppender(d->m_rollingFileAppender);
+    d->m_rollingFileAppender->setDiskBudget(d->m_logFilesDiskBudget);
+    d->m_rollingFileAppender->setMaxFileSize(d->m_maxLogFileSize);
+    d->registerAppender(QStringLiteral("file"), d->m_rollingFileAppender);
+}
+
+static void flushAsyncAppenders()
+{
+    AsyncAppender::flushAll();
+}
+
+void DLogManager::initAsyncFileAppender(OverflowPolicy policy, int queueCapacity)
+{
+    Q_D(DLogManager);
+    if (d->m_rollingFileAppender) {
+        qWarning() << "a file appender is registered already, the async file appender isn't registered";
+        return;
+    }
+    d->m_rollingFileAppender = new FormattedRollingFileAppender(getlogFilePath(), d->m_format);
+    d->m_rollingFileAppender->setLogFilesLimit(5);
+    d->m_rollingFileAppender->setDatePattern(RollingFileAppender::DailyRollover);
+    d->m_rollingFileAppender->setDiskBudget(d->m_logFilesDiskBudget);
+    d->m_rollingFileAppender->setMaxFileSize(d->m_maxLogFileSize);
+
+    // the rolling file appender is owned by the async appender and only used in its writer thread.
+    d->m_asyncFileAppender = new AsyncAppender(d->m_rollingFileAppender, policy, queueCapacity);
+    d->registerAppender(QStringLiteral("asyncfile"), d->m_asyncFileAppender);
+
+    static bool postRoutineAdded = false;
+    if (!postRoutineAdded) {
+        qAddPostRoutine(flushAsyncAppenders);
+        postRoutineAdded = true;
+    }
+}
+
+void DLogManager::initBinaryFileAppender()
+{
+    Q_D(DLogManager);
+    const QString &path = getBinaryLogFilePath();
+    if (path.isEmpty())
+        return;
+
+    d->m_binaryFileAppender = new BinaryAppender(path);
+    d->registerAppender(QStringLiteral("binaryfile"), d->m_binaryFileAppender);
+}
+
+void DLogManager::initFlightRecorderAppender(int capacity)
+{
+    Q_D(DLogManager);
+    const QString &path = getFlightRecorderFilePath();
+    if (path.isEmpty() || d->m_flightRecorderAppender)
+        return;
+
+    auto appender = new FlightRecorderAppender(path, capacity);
+    if (!appender->isMapped()) {
+        delete appender;
+        return;
+    }
+
+    d->m_flightRecorderAppender = appender;
+    d->registerAppender(QStringLiteral("flightrecorder"), d->m_flightRecorderAppender);
 }
 
 void DLogManager::initJournalAppender()
@@ -206,13 +372,12 @@ void DLogManager::initJournalAppender()
 #if (defined BUILD_WITH_SYSTEMD && defined Q_OS_LINUX)
     Q_D(DLogManager);
     d->m_journalAppender = new JournalAppender();
-    dlogger->registerAppender(d->m_journalAppender);
+    d->registerAppender(QStringLiteral("journal"), d->m_journalAppender);
     
     // Unregister ConsoleAppender if already registered under systemd to avoid duplicate logging
     if (d->shouldSkipConsoleAppender() && d->m_consoleAppender) {
         qDebug() << "Unregistered ConsoleAppender to avoid duplicate logging with JournalAppender under systemd";
-        dlogger->unregisterAppender(d->m_consoleAppender);
-        delete d->m_consoleAppender;
+        d->unregisterAppender(d->m_consoleAppender);
         d->m_consoleAppender = nullptr;
     }
     
@@ -242,11 +407,156 @@ void DLogManager::registerFileAppender() {
     DLogManager::instance()->initRollingFileAppender();
 }
 
+/*!
+@~english
+  \brief Registers the appender to write the log records to the file in a background thread.
+
+  The logging thread only puts the records into a bounded queue with \a queueCapacity
+  records, they are formatted and written to the same file as registerFileAppender() does
+  by a background thread. When the queue is full, \a policy decides whether the logging
+  thread waits or the record is dropped. The queued records are written before a
+  fatal message aborts the process and when the application exits. Only the first
+  one of registerFileAppender() and registerAsyncFileAppender() takes effect, as they
+  write the same file.
+
+  \sa registerFileAppender
+  \sa droppedLogCount
+ */
+void DLogManager::registerAsyncFileAppender(OverflowPolicy policy, int queueCapacity)
+{
+    DLogManager::instance()->initAsyncFileAppender(policy, queueCapacity);
+}
+
+/*!
+@~english
+  \brief Registers the appender to write the log records to a file in a compact binary format.
+
+  The records aren't formatted as text when logging, their time, level, category and
+  source location are stored compactly, the message is stored as text. The records
+  are written to the file at most a second after they are logged, the errors at once.
+  Use the dtk-log-decoder tool to read the file.
+
+  \sa getBinaryLogFilePath
+  \sa registerFileAppender
+ */
+void DLogManager::registerBinaryFileAppender()
+{
+    DLogManager::instance()->initBinaryFileAppender();
+}
+
+/*!
+@~english
+  \brief Registers the appender to keep the last log records in a memory mapped ring file.
+
+  Logging only copies the record into the mapping of the file, so it's cheap
+  enough to be always enabled with verbose logging. The records survive a crash
+  of the process, the file of the previous run is kept with a `.1` suffix, use
+  the dtk-log-decoder tool to read the last records from it.
+
+  \a capacity is the size of the ring in bytes, the oldest records are overwritten
+  when it's full.
+
+  \sa getFlightRecorderFilePath
+ */
+void DLogManager::registerFlightRecorderAppender(int capacity)
+{
+    DLogManager::instance()->initFlightRecorderAppender(capacity);
+}
+
 void DLogManager::registerJournalAppender()
 {
     DLogManager::instance()->initJournalAppender();
 }
 
+/*!
+@~english
+  \brief Returns the number of log records dropped by the async file appender since it's registered.
+
+  \sa registerAsyncFileAppender
+ */
+quint64 DLogManager::droppedLogCount()
+{
+    auto appender = DLogManager::instance()->d_func()->m_asyncFileAppender;
+    return appender ? appender->droppedCount() : 0;
+}
+
+/*!
+@~english
+  \brief Returns the log metrics per logging category.
+
+  The keys are the category names, records without a category are counted as
+  `default`. Each value is a map with the number of `messages`, their size in
+  UTF-8 `bytes` and the number of messages `dropped` by the rate limit of the
+  logging rules. Only the records of the categories enabled by the logging rules
+  are counted, once an appender is registered.
+
+  \sa appenderMetrics
+  \sa resetMetrics
+ */
+QVariantMap DLogManager::categoryMetrics()
+{
+    return LogMetrics::instance()->categories();
+}
+
+/*!
+@~english
+  \brief Returns the log metrics per appender registered by DLogManager.
+
+  The keys are `console`, `file`, `asyncfile`, `binaryfile`, `flightrecorder` and
+  `journal`. Each value is a map with the number of `messages` written to the
+  appender, their size in UTF-8 `bytes`, the messages `dropped` by the appender
+  and the time in nanoseconds the logging threads spent in it, `nsecs`.
+
+  \sa categoryMetrics
+ */
+QVariantMap DLogManager::appenderMetrics()
+{
+    QVariantMap metrics = LogMetrics::instance()->appenders();
+    auto asyncFileAppender = DLogManager::instance()->d_func()->m_asyncFileAppender;
+    if (asyncFileAppender && metrics.contains(QStringLiteral("asyncfile"))) {
+        QVariantMap async = metrics.value(QStringLiteral("asyncfile")).toMap();
+        async.insert(QStringLiteral("dropped"), asyncFileAppender->droppedCount());
+        metrics.insert(QStringLiteral("asyncfile"), async);
+    }
+    return metrics;
+}
+
+/*!
+@~english
+  \brief Sets the counters of categoryMetrics() and appenderMetrics() to zero.
+ */
+void DLogManager::resetMetrics()
+{
+    LogMetrics::instance()->reset();
+}
+
+/*!
+@~english
+  \brief Registers the `logMetrics` and `resetLogMetrics` actions to \a interface.
+
+  `logMetrics` returns a JSON object with the `categories` and `appenders`
+  metrics, so they can be queried while the application is running.
+
+  \sa categoryMetrics
+  \sa appenderMetrics
+ */
+void DLogManager::exportMetrics(DUtil::DExportedInterface *interface)
+{
+    interface->registerAction(QStringLiteral("logMetrics"), QStringLiteral("the log metrics per category and appender"),
+                              [](QString) -> QVariant {
+        const QJsonObject metrics {
+            {QStringLiteral("categories"), QJsonObject::fromVariantMap(categoryMetrics())},
+            {QStringLiteral("appenders"), QJsonObject::fromVariantMap(appenderMetrics())}
+        };
+        return QString::fromUtf8(QJsonDocument(metrics).toJson(QJsonDocument::Compact));
+    });
+    interface->registerAction(QStringLiteral("resetLogMetrics"), QStringLiteral("reset the log metrics"),
+                              [](QString) -> QVariant {
+        resetMetrics();
+        return QVariant();
+    });
+}
+
 /*!
 @~english
   \brief Return the path file log storage.
@@ -278,6 +588,40 @@ QString DLogManager::getlogFilePath()
     return QDir::toNativeSeparators(DLogManager::instance()->d_func()->m_logPath);
 }
 
+/*!
+@~english
+  \brief Return the path of the binary log file, getlogFilePath() with the `.blog` suffix instead of `.log`.
+
+  \sa registerBinaryFileAppender
+ */
+QString DLogManager::getBinaryLogFilePath()
+{
+    QString path = getlogFilePath();
+    if (path.isEmpty())
+        return path;
+
+    if (path.endsWith(QLatin1String(".log")))
+        path.chop(4);
+    return path + QLatin1String(".blog");
+}
+
+/*!
+@~english
+  \brief Return the path of the flight recorder file, getlogFilePath() with the `.flight` suffix instead of `.log`.
+
+  \sa registerFlightRecorderAppender
+ */
+QString DLogManager::getFlightRecorderFilePath()
+{
+    QString path = getlogFilePath();
+    if (path.isEmpty())
+        return path;
+
+    if (path.endsWith(QLatin1String(".log")))
+        path.chop(4);
+    return path + QLatin1String(".flight");
+}
+
 /*!
 @~english
   \brief DLogManager::setlogFilePath Set the log file path
@@ -293,6 +637,26 @@ void DLogManager::setlogFilePath(const QString &logFilePath)
         DLogManager::instance()->d_func()->m_logPath = logFilePath;
 }
 
+/*!
+@~english
+  \brief Rotates the log file of registerFileAppender() and registerAsyncFileAppender()
+  when it's larger than \a maxFileSize bytes, in addition to the daily rotation.
+
+  The rotated files are compressed with gzip in a background thread, the logging
+  threads never wait for it. The oldest compressed files are removed when they
+  take more than \a diskBudget bytes, 0 keeps up to five times \a maxFileSize.
+  A \a maxFileSize of 0 disables the rotation by size. Call it before registering
+  the file appender.
+
+  \sa registerFileAppender
+ */
+void DLogManager::setMaxLogFileSize(qint64 maxFileSize, qint64 diskBudget)
+{
+    auto d = DLogManager::instance()->d_func();
+    d->m_maxLogFileSize = qMax<qint64>(maxFileSize, 0);
+    d->m_logFilesDiskBudget = diskBudget > 0 ? diskBudget : d->m_maxLogFileSize * 5;
+}
+
 void DLogManager::setLogFormat(const QString &format)
 {
     //m_format = "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}\n";
@@ -306,6 +670,9 @@ QString DLogManager::joinPath(const QString &path, const QString &fileName){
 
 DLogManager::~DLogManager()
 {
+    EarlyLogBuffer::instance()->release();
+    // exit() was called without destroying the application, write the queued records.
+    AsyncAppender::flushAll();
 }
 
 DCORE_END_NAMESPACE
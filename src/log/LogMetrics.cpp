@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "LogMetrics.h"
+
+#include <QElapsedTimer>
+
+#include <utility>
+
+DCORE_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(LogMetrics, globalLogMetrics)
+
+void LogMetrics::Counters::reset()
+{
+    messages.storeRelaxed(0);
+    bytes.storeRelaxed(0);
+    dropped.storeRelaxed(0);
+    nsecs.storeRelaxed(0);
+}
+
+QVariantMap LogMetrics::Counters::toMap() const
+{
+    return {
+        {QStringLiteral("messages"), messages.loadRelaxed()},
+        {QStringLiteral("bytes"), bytes.loadRelaxed()},
+        {QStringLiteral("dropped"), dropped.loadRelaxed()},
+        {QStringLiteral("nsecs"), nsecs.loadRelaxed()}
+    };
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::LogMetrics
+
+  \brief LogMetrics keeps the number of messages, their size in bytes, the
+  dropped messages and the time spent per logging category and per appender.
+
+  Counting a record is a few relaxed atomic additions, the counters are
+  looked up under a read lock and only created under the write lock.
+ */
+LogMetrics::~LogMetrics()
+{
+    qDeleteAll(m_categories);
+    qDeleteAll(m_appenders);
+}
+
+LogMetrics *LogMetrics::instance()
+{
+    return globalLogMetrics;
+}
+
+quint64 LogMetrics::utf8Size(const QString &message)
+{
+    quint64 size = 0;
+    for (const QChar c : message) {
+        const ushort unicode = c.unicode();
+        if (unicode < 0x80)
+            size += 1;
+        else if (unicode < 0x800)
+            size += 2;
+        else if (c.isSurrogate())
+            size += 2;  // a pair is 4 bytes
+        else
+            size += 3;
+    }
+    return size;
+}
+
+LogMetrics::Counters *LogMetrics::category(const QByteArray &name)
+{
+    const QByteArray &key = name.isEmpty() ? QByteArrayLiteral("default") : name;
+    {
+        QReadLocker locker(&m_lock);
+        if (Counters *counters = m_categories.value(key))
+            return counters;
+    }
+
+    QWriteLocker locker(&m_lock);
+    Counters *&counters = m_categories[key];
+    if (!counters)
+        counters = new Counters;
+    return counters;
+}
+
+LogMetrics::Counters *LogMetrics::appender(const QString &name)
+{
+    QWriteLocker locker(&m_lock);
+    Counters *&counters = m_appenders[name];
+    if (!counters)
+        counters = new Counters;
+    return counters;
+}
+
+QVariantMap LogMetrics::categories() const
+{
+    QReadLocker locker(&m_lock);
+    QVariantMap result;
+    for (auto it = m_categories.constBegin(); it != m_categories.constEnd(); ++it)
+        result.insert(QString::fromUtf8(it.key()), it.value()->toMap());
+    return result;
+}
+
+QVariantMap LogMetrics::appenders() const
+{
+    QReadLocker locker(&m_lock);
+    QVariantMap result;
+    for (auto it = m_appenders.constBegin(); it != m_appenders.constEnd(); ++it)
+        result.insert(it.key(), it.value()->toMap());
+    return result;
+}
+
+void LogMetrics::reset()
+{
+    QReadLocker locker(&m_lock);
+    for (Counters *counters : std::as_const(m_categories))
+        counters->reset();
+    for (Counters *counters : std::as_const(m_appenders))
+        counters->reset();
+}
+
+void CategoryMetricsAppender::append(const QDateTime &, Logger::LogLevel, const char *, int,
+                                     const char *, const QString &category, const QString &message)
+{
+    // write() is serialized, most records have the category of the previous one.
+    if (!m_lastCounters || category != m_lastCategory) {
+        m_lastCounters = LogMetrics::instance()->category(category.toUtf8());
+        m_lastCategory = category;
+    }
+
+    m_lastCounters->messages.fetchAndAddRelaxed(1);
+    m_lastCounters->bytes.fetchAndAddRelaxed(LogMetrics::utf8Size(message));
+}
+
+InstrumentedAppender::InstrumentedAppender(const QString &name, AbstractAppender *target)
+    : m_target(target)
+    , m_counters(LogMetrics::instance()->appender(name))
+{
+}
+
+InstrumentedAppender::~InstrumentedAppender()
+{
+    delete m_target;
+}
+
+void InstrumentedAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                                  const char *function, const QString &category, const QString &message)
+{
+    if (level < m_target->detailsLevel())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    m_target->write(time, level, file, line, function, category, message);
+    m_counters->nsecs.fetchAndAddRelaxed(quint64(timer.nsecsElapsed()));
+    m_counters->messages.fetchAndAddRelaxed(1);
+    m_counters->bytes.fetchAndAddRelaxed(LogMetrics::utf8Size(message));
+}
+
+DCORE_END_NAMESPACE
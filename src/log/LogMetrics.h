@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef LOGMETRICS_H
+#define LOGMETRICS_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVariantMap>
+
+#include <AbstractAppender.h>
+
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Counters of the log records per category and per appender, the counters
+ * are created once and never removed, so a pointer to them stays valid.
+ */
+class LogMetrics
+{
+    Q_DISABLE_COPY(LogMetrics)
+public:
+    struct Counters
+    {
+        QAtomicInteger<quint64> messages;
+        QAtomicInteger<quint64> bytes;
+        QAtomicInteger<quint64> dropped;
+        QAtomicInteger<quint64> nsecs;
+
+        void reset();
+        QVariantMap toMap() const;
+    };
+
+    LogMetrics() = default;
+    ~LogMetrics();
+
+    static LogMetrics *instance();
+    // the size of the message encoded as UTF-8, without encoding it.
+    static quint64 utf8Size(const QString &message);
+
+    // an empty name is the "default" category.
+    Counters *category(const QByteArray &name);
+    Counters *appender(const QString &name);
+
+    // name -> {messages, bytes, dropped, nsecs}
+    QVariantMap categories() const;
+    QVariantMap appenders() const;
+    void reset();
+
+private:
+    mutable QReadWriteLock m_lock;
+    QHash<QByteArray, Counters *> m_categories;
+    QHash<QString, Counters *> m_appenders;
+};
+
+/*
+ * Counts every record Logger dispatches by category, it's registered before
+ * the other appenders of DLogManager.
+ */
+class CategoryMetricsAppender : public AbstractAppender
+{
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *function, const QString &category, const QString &message) override;
+
+private:
+    QString m_lastCategory;
+    LogMetrics::Counters *m_lastCounters = nullptr;
+};
+
+/*
+ * Owns an appender and counts the records written to it and the time spent
+ * in its write(), which is the time the logging thread waits for it.
+ */
+class InstrumentedAppender : public AbstractAppender
+{
+    Q_DISABLE_COPY(InstrumentedAppender)
+public:
+    explicit InstrumentedAppender(const QString &name, AbstractAppender *target);
+    ~InstrumentedAppender() override;
+
+    AbstractAppender *target() const { return m_target; }
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *function, const QString &category, const QString &message) override;
+
+private:
+    AbstractAppender *m_target;
+    LogMetrics::Counters *m_counters;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // LOGMETRICS_H
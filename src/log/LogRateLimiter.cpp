@@ -0,0 +1,256 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "LogRateLimiter.h"
+
+#include <QRegularExpression>
+
+#include <Logger.h>
+
+#include <cstdio>
+
+DCORE_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(LogRateLimiter, globalRateLimiter)
+
+static const QString RateLimitSuffix = QStringLiteral(".ratelimit");
+static const QString SuppressRepeatedSuffix = QStringLiteral(".suppressrepeated");
+static QtMessageHandler previousHandler = nullptr;
+// a flood of the same message is still summarized at this interval.
+static constexpr qint64 RepeatSummaryInterval = 10 * 1000;
+
+static bool categoryMatches(const QString &pattern, const QString &category)
+{
+    if (pattern == QLatin1String("*"))
+        return true;
+    if (pattern.endsWith(QLatin1Char('*')))
+        return category.startsWith(pattern.left(pattern.size() - 1));
+    if (pattern.startsWith(QLatin1Char('*')))
+        return category.endsWith(pattern.mid(1));
+    return pattern == category;
+}
+
+// <category>[.<type>]=true|false, the category may start or end with `*`.
+static bool isValidFilterRule(const QString &key, const QString &value)
+{
+    if (key.isEmpty() || (value != QLatin1String("true") && value != QLatin1String("false")))
+        return false;
+
+    QString category = key;
+    for (const char *type : {".debug", ".info", ".warning", ".critical"}) {
+        if (category.endsWith(QLatin1String(type))) {
+            category.chop(int(qstrlen(type)));
+            break;
+        }
+    }
+    if (category == QLatin1String("*"))
+        return true;
+
+    // a leading and/or a trailing `*` only.
+    const int begin = category.startsWith(QLatin1Char('*')) ? 1 : 0;
+    const int end = category.endsWith(QLatin1Char('*')) ? category.size() - 1 : category.size();
+    return end > begin && category.mid(begin, end - begin).indexOf(QLatin1Char('*')) < 0;
+}
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::LogRateLimiter
+
+  \brief LogRateLimiter drops the Qt messages of a logging category which logs too often.
+
+  Every category with a `ratelimit` rule has a token bucket holding up to
+  `count` tokens, refilled with `count` tokens per `seconds`, a message
+  without a token is dropped. With `suppressrepeated`, a message which is the
+  same as the previous one of its category is dropped.
+ */
+LogRateLimiter::LogRateLimiter()
+{
+    m_clock.start();
+}
+
+LogRateLimiter *LogRateLimiter::instance()
+{
+    return globalRateLimiter;
+}
+
+QString LogRateLimiter::parseRules(const QString &rules, QVector<Rule> *limits)
+{
+    static const QRegularExpression separator(QStringLiteral("[;\\n]"));
+    static const QRegularExpression rateLimit(QStringLiteral("^(\\d+)(?:/(\\d+))?$"));
+
+    QStringList filterRules;
+    for (const QString &entry : rules.split(separator, Qt::SkipEmptyParts)) {
+        const QString &rule = entry.trimmed();
+        const int equal = rule.indexOf(QLatin1Char('='));
+        const QString &key = rule.left(equal).trimmed();
+        const QString &value = rule.mid(equal + 1).trimmed();
+
+        if (equal > 0 && key.endsWith(RateLimitSuffix)) {
+            const auto &match = rateLimit.match(value);
+            const int seconds = match.captured(2).isEmpty() ? 1 : match.captured(2).toInt();
+            if (!match.hasMatch() || seconds <= 0) {
+                qWarning("Ignoring malformed logging rule: \"%s\"", qUtf8Printable(rule));
+                continue;
+            }
+
+            Rule limit;
+            limit.category = key.left(key.size() - RateLimitSuffix.size());
+            limit.count = match.captured(1).toInt();
+            limit.seconds = seconds;
+            limits->append(limit);
+        } else if (equal > 0 && key.endsWith(SuppressRepeatedSuffix)) {
+            if (value != QLatin1String("true") && value != QLatin1String("false")) {
+                qWarning("Ignoring malformed logging rule: \"%s\"", qUtf8Printable(rule));
+                continue;
+            }
+
+            Rule limit;
+            limit.category = key.left(key.size() - SuppressRepeatedSuffix.size());
+            limit.suppressRepeated = value == QLatin1String("true");
+            limits->append(limit);
+        } else if (!rule.isEmpty()) {
+            if (!isValidFilterRule(key, value)) {
+                qWarning("Ignoring malformed logging rule: \"%s\"", qUtf8Printable(rule));
+                continue;
+            }
+            filterRules.append(key + QLatin1Char('=') + value);
+        }
+    }
+
+    return filterRules.join(QLatin1Char('\n'));
+}
+
+QVector<LogRateLimiter::Rule> LogRateLimiter::rules() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_rules;
+}
+
+void LogRateLimiter::setRules(const QVector<Rule> &rules)
+{
+    QMutexLocker locker(&m_mutex);
+    m_rules = rules;
+    m_states.clear();
+}
+
+void LogRateLimiter::installMessageHandler()
+{
+    static bool installed = false;
+    if (installed)
+        return;
+
+    // Logger installs its handler when it's created, ours runs before it.
+    Logger::globalInstance();
+    previousHandler = qInstallMessageHandler(messageHandler);
+    installed = true;
+}
+
+void LogRateLimiter::resolve(State &state, const QString &category) const
+{
+    for (const Rule &rule : m_rules) {
+        if (!categoryMatches(rule.category, category))
+            continue;
+
+        if (rule.count >= 0) {
+            state.count = rule.count;
+            state.seconds = rule.seconds;
+        }
+        if (rule.suppressRepeated >= 0)
+            state.suppressRepeated = rule.suppressRepeated;
+    }
+
+    state.tokens = state.count;
+    state.resolved = true;
+}
+
+bool LogRateLimiter::filter(const char *category, QtMsgType type, const QString &message, qint64 msecs, QStringList *summaries)
+{
+    if (type == QtFatalMsg)
+        return true;
+
+    if (!category)
+        category = "default";
+
+    QMutexLocker locker(&m_mutex);
+    if (m_rules.isEmpty())
+        return true;
+
+    auto it = m_states.find(QByteArray::fromRawData(category, int(qstrlen(category))));
+    if (it == m_states.end())
+        it = m_states.insert(QByteArray(category), State());
+
+    State &state = it.value();
+    if (!state.resolved) {
+        resolve(state, QString::fromLatin1(category));
+        state.metrics = LogMetrics::instance()->category(it.key());
+        state.lastRefill = msecs;
+    }
+    if (!state.count && !state.suppressRepeated)
+        return true;
+
+    if (state.suppressRepeated) {
+        if (type == state.lastType && message == state.lastMessage) {
+            if (!state.repeated)
+                state.firstRepeated = msecs;
+            ++state.repeated;
+            if (msecs - state.firstRepeated >= RepeatSummaryInterval) {
+                summaries->append(QStringLiteral("The previous message was repeated %1 times").arg(state.repeated));
+                state.repeated = 0;
+            }
+            state.metrics->dropped.fetchAndAddRelaxed(1);
+            return false;
+        }
+
+        if (state.repeated) {
+            summaries->append(QStringLiteral("The previous message was repeated %1 times").arg(state.repeated));
+            state.repeated = 0;
+        }
+        state.lastType = type;
+        state.lastMessage = message;
+    }
+
+    if (state.count > 0) {
+        const double perMsec = double(state.count) / (state.seconds * 1000.0);
+        state.tokens = qMin<double>(state.count, state.tokens + (msecs - state.lastRefill) * perMsec);
+        state.lastRefill = msecs;
+        if (state.tokens < 1) {
+            ++state.rateLimited;
+            state.metrics->dropped.fetchAndAddRelaxed(1);
+            return false;
+        }
+
+        state.tokens -= 1;
+        if (state.rateLimited) {
+            summaries->append(QStringLiteral("%1 messages were dropped by the rate limit of \"%2\"")
+                                  .arg(state.rateLimited).arg(QString::fromLatin1(category)));
+            state.rateLimited = 0;
+        }
+    }
+
+    return true;
+}
+
+void LogRateLimiter::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    LogRateLimiter *limiter = instance();
+    QStringList summaries;
+    const bool accepted = limiter->filter(context.category, type, message, limiter->m_clock.elapsed(), &summaries);
+
+    auto forward = [&context](QtMsgType type, const QString &message) {
+        if (previousHandler) {
+            previousHandler(type, context, message);
+        } else {
+            fprintf(stderr, "%s\n", qUtf8Printable(qFormatLogMessage(type, context, message)));
+            fflush(stderr);
+        }
+    };
+
+    for (const QString &summary : summaries)
+        forward(QtInfoMsg, summary);
+    if (accepted)
+        forward(type, message);
+}
+
+DCORE_END_NAMESPACE
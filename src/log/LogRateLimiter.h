@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef LOGRATELIMITER_H
+#define LOGRATELIMITER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+#include "LogMetrics.h"
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Rate limiting and duplicate suppression of the Qt messages per logging
+ * category, configured with extra entries in the logging rules:
+ *
+ *   <category>.ratelimit=<count>[/<seconds>]   at most count messages per seconds (default 1)
+ *   <category>.suppressrepeated=true|false     drop identical consecutive messages
+ *
+ * Categories may end with `*` or be `*` like the Qt rules, the last matching
+ * entry wins. Dropped messages are summarized by a message of the category
+ * when it logs again. Fatal messages are never dropped.
+ */
+class LogRateLimiter
+{
+    Q_DISABLE_COPY(LogRateLimiter)
+public:
+    struct Rule
+    {
+        QString category;
+        // 0 is unlimited, -1 keeps the limit of an earlier rule.
+        int count = -1;
+        int seconds = 1;
+        // -1 keeps the value of an earlier rule.
+        int suppressRepeated = -1;
+
+        bool operator==(const Rule &other) const
+        {
+            return category == other.category && count == other.count && seconds == other.seconds
+                    && suppressRepeated == other.suppressRepeated;
+        }
+    };
+
+    LogRateLimiter();
+
+    static LogRateLimiter *instance();
+
+    // splits the rate limit entries from the Qt filter rules, the remaining rules are returned separated by '\n'.
+    // Malformed entries are dropped with a warning, so Qt doesn't warn about them for every update.
+    static QString parseRules(const QString &rules, QVector<Rule> *limits);
+
+    // installs the message handler of instance() in front of the one of Logger, once.
+    static void installMessageHandler();
+
+    QVector<Rule> rules() const;
+    void setRules(const QVector<Rule> &rules);
+
+    // returns false to drop the message, summaries of dropped messages are appended to be logged before it.
+    bool filter(const char *category, QtMsgType type, const QString &message, qint64 msecs, QStringList *summaries);
+
+private:
+    struct State
+    {
+        bool resolved = false;
+        int count = 0;
+        int seconds = 1;
+        bool suppressRepeated = false;
+
+        double tokens = 0;
+        qint64 lastRefill = 0;
+        quint64 rateLimited = 0;
+        LogMetrics::Counters *metrics = nullptr;
+
+        QtMsgType lastType = QtDebugMsg;
+        QString lastMessage;
+        quint64 repeated = 0;
+        qint64 firstRepeated = 0;
+    };
+
+    void resolve(State &state, const QString &category) const;
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message);
+
+    mutable QMutex m_mutex;
+    QVector<Rule> m_rules;
+    QHash<QByteArray, State> m_states;
+    QElapsedTimer m_clock;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // LOGRATELIMITER_H
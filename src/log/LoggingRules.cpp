@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "LoggingRules.h"
+
+#include <QLoggingCategory>
+
+DCORE_BEGIN_NAMESPACE
+
+/*!
+@~english
+  \internal
+  \class Dtk::Core::LoggingRules
+
+  \brief LoggingRules applies the logging rules read from DConfig.
+
+  The rules are validated and normalized first, only the parts which differ
+  from the rules applied last are applied: the Qt filter rules and the rate
+  limits of LogRateLimiter.
+ */
+bool LoggingRules::apply(const QString &rules)
+{
+    QVector<LogRateLimiter::Rule> limits;
+    const QString &filterRules = LogRateLimiter::parseRules(rules, &limits);
+    bool changed = false;
+
+    if (!m_applied || filterRules != m_filterRules) {
+        QLoggingCategory::setFilterRules(filterRules);
+        m_filterRules = filterRules;
+        changed = true;
+    }
+
+    if (limits != m_limits) {
+        LogRateLimiter::instance()->setRules(limits);
+        if (!limits.isEmpty())
+            LogRateLimiter::installMessageHandler();
+        m_limits = limits;
+        changed = true;
+    }
+
+    m_applied = true;
+    return changed;
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef LOGGINGRULES_H
+#define LOGGINGRULES_H
+
+#include <QString>
+#include <QVector>
+
+#include "LogRateLimiter.h"
+#include "dtkcore_global.h"
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * The logging rules applied last, setting the same rules again is skipped.
+ * QLoggingCategory::setFilterRules() updates every category of the process.
+ */
+class LoggingRules
+{
+public:
+    // returns true if the Qt filter rules or the rate limits changed and were applied.
+    bool apply(const QString &rules);
+
+    QString filterRules() const { return m_filterRules; }
+    QVector<LogRateLimiter::Rule> limits() const { return m_limits; }
+
+private:
+    bool m_applied = false;
+    QString m_filterRules;
+    QVector<LogRateLimiter::Rule> m_limits;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // LOGGINGRULES_H
@@ -3,6 +3,24 @@ file(GLOB LOG_HEADER
 )
 set(LOG_SOURCE
   ${CMAKE_CURRENT_LIST_DIR}/LogManager.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/AsyncAppender.h
+  ${CMAKE_CURRENT_LIST_DIR}/AsyncAppender.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/LogFormatter.h
+  ${CMAKE_CURRENT_LIST_DIR}/LogFormatter.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/LogCompressor.h
+  ${CMAKE_CURRENT_LIST_DIR}/LogCompressor.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/BinaryAppender.h
+  ${CMAKE_CURRENT_LIST_DIR}/BinaryAppender.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/FlightRecorderAppender.h
+  ${CMAKE_CURRENT_LIST_DIR}/FlightRecorderAppender.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/LogRateLimiter.h
+  ${CMAKE_CURRENT_LIST_DIR}/LogRateLimiter.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/LoggingRules.h
+  ${CMAKE_CURRENT_LIST_DIR}/LoggingRules.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/LogMetrics.h
+  ${CMAKE_CURRENT_LIST_DIR}/LogMetrics.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/EarlyLogBuffer.h
+  ${CMAKE_CURRENT_LIST_DIR}/EarlyLogBuffer.cpp
   ${CMAKE_CURRENT_LIST_DIR}/dconfig_org_deepin_dtk_preference.hpp
 )
 
@@ -1,4 +1,4 @@
-// SPDX-FileCopyrightText: 2021 - 2022 UnionTech Software Technology Co., Ltd.
+// SPDX-FileCopyrightText: 2021 - 2026 UnionTech Software Technology Co., Ltd.
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
@@ -6,27 +6,98 @@
 
 #include <QDebug>
 #include <QMutex>
+#include <QTimer>
 #include <DConfig>
 
 DCORE_BEGIN_NAMESPACE
 
+// pending options are written to DConfig after no option was changed for this interval.
+static constexpr int FlushInterval = 200;
+
 class DSettingsDConfigBackendPrivate
 {
 public:
     explicit DSettingsDConfigBackendPrivate(DSettingsDConfigBackend *parent) : q_ptr(parent) {}
 
+    bool enqueue(const QString &key, const QVariant &value);
+    void flush();
+    void onConfigValueChanged(const QString &key);
+
     DConfig       *dConfig   = nullptr;
-    QMutex          writeLock;
+    QTimer        *flushTimer = nullptr;
+    mutable QMutex  writeLock;
+
+    // keys of DConfig are fixed by its meta file, so they are listed once.
+    QStringList             keys;
+
+    QVariantMap             pendingValues;
+    QVariantMap             writtenValues;
 
     DSettingsDConfigBackend *q_ptr;
     Q_DECLARE_PUBLIC(DSettingsDConfigBackend)
 };
 
+// writeLock must be held. A value already stored in DConfig isn't queued unless another
+// value is pending, e.g. an external change mirrored back by DSettings through setOption().
+bool DSettingsDConfigBackendPrivate::enqueue(const QString &key, const QVariant &value)
+{
+    if (!pendingValues.contains(key) && dConfig->value(key) == value)
+        return false;
+
+    pendingValues.insert(key, value);
+    return true;
+}
+
+void DSettingsDConfigBackendPrivate::flush()
+{
+    writeLock.lock();
+    const QVariantMap values = pendingValues;
+    pendingValues.clear();
+    writeLock.unlock();
+    if (values.isEmpty())
+        return;
+
+    // only the echoes of the last batch are expected, a later echo is dropped by enqueue().
+    writtenValues.clear();
+
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        // remember the value, the change notification of our own write needn't to be mirrored.
+        writtenValues.insert(it.key(), it.value());
+        dConfig->setValue(it.key(), it.value());
+    }
+}
+
+void DSettingsDConfigBackendPrivate::onConfigValueChanged(const QString &key)
+{
+    Q_Q(DSettingsDConfigBackend);
+    writeLock.lock();
+    const bool isPending = pendingValues.contains(key);
+    writeLock.unlock();
+    // a newer value will be written, don't override it with the old one.
+    if (isPending)
+        return;
+
+    const QVariant &value = dConfig->value(key);
+    auto written = writtenValues.find(key);
+    if (written != writtenValues.end()) {
+        const bool isEcho = written.value() == value;
+        writtenValues.erase(written);
+        if (isEcho)
+            return;
+    }
+
+    Q_EMIT q->optionChanged(key, value);
+}
+
 /*!
 @~english
   @class Dtk::Core::DSettingsDConfigBackend
   \inmodule dtkcore
   @brief Storage DSetttings to an DConfig.
+
+  Options set to the backend are buffered and written to DConfig in batch, when
+  doSync() is called or no option was changed for a short while. Changes made to
+  the DConfig by others are reported by optionChanged().
  */
 
 /*!
@@ -42,11 +113,25 @@ DSettingsDConfigBackend::DSettingsDConfigBackend(const QString &name, const QStr
     Q_D(DSettingsDConfigBackend);
 
     d->dConfig = new DConfig(name, subpath, this);
+    d->keys = d->dConfig->keyList();
+
+    // the timer is a child of backend, so it is moved to the write thread together with the backend.
+    d->flushTimer = new QTimer(this);
+    d->flushTimer->setSingleShot(true);
+    d->flushTimer->setInterval(FlushInterval);
+    connect(d->flushTimer, &QTimer::timeout, this, [d]() {
+        d->flush();
+    });
+
+    connect(d->dConfig, &DConfig::valueChanged, this, [d](const QString &key) {
+        d->onConfigValueChanged(key);
+    });
 }
 
 DSettingsDConfigBackend::~DSettingsDConfigBackend()
 {
-
+    Q_D(DSettingsDConfigBackend);
+    d->flush();
 }
 
 /*!
@@ -57,33 +142,61 @@ DSettingsDConfigBackend::~DSettingsDConfigBackend()
 QStringList DSettingsDConfigBackend::keys() const
 {
     Q_D(const DSettingsDConfigBackend);
-    return d->dConfig->keyList();
+    return d->keys;
 }
 
 /*!
 @~english
-  @brief Get value of key from DConfig
+  @brief Get value of key from DConfig, the value isn't written to DConfig yet is returned first.
   \a key
   @return
  */
 QVariant DSettingsDConfigBackend::getOption(const QString &key) const
 {
     Q_D(const DSettingsDConfigBackend);
+    {
+        QMutexLocker locker(&d->writeLock);
+        auto it = d->pendingValues.constFind(key);
+        if (it != d->pendingValues.constEnd())
+            return it.value();
+    }
+
     return d->dConfig->value(key);
 }
 
 /*!
 @~english
-  @brief Set value of key to DConfig
+  @brief Set value of key to DConfig, the value is buffered and written in batch later.
   \a key
   \a value
+  @sa doSync()
  */
 void DSettingsDConfigBackend::doSetOption(const QString &key, const QVariant &value)
 {
     Q_D(DSettingsDConfigBackend);
     d->writeLock.lock();
-    d->dConfig->setValue(key, value);
+    const bool queued = d->enqueue(key, value);
     d->writeLock.unlock();
+
+    if (queued)
+        d->flushTimer->start();
+}
+
+/*!
+@~english
+  @brief Set all \a values to DConfig at once.
+  @sa DSettings::commit()
+ */
+void DSettingsDConfigBackend::doSetOptions(const QVariantMap &values)
+{
+    Q_D(DSettingsDConfigBackend);
+    d->writeLock.lock();
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+        d->enqueue(it.key(), it.value());
+    d->writeLock.unlock();
+
+    d->flushTimer->stop();
+    d->flush();
 }
 
 /*!
@@ -93,8 +206,8 @@ void DSettingsDConfigBackend::doSetOption(const QString &key, const QVariant &va
 void DSettingsDConfigBackend::doSync()
 {
     Q_D(DSettingsDConfigBackend);
-
-    // TODO
+    d->flushTimer->stop();
+    d->flush();
 }
 
 
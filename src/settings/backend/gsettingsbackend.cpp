@@ -6,6 +6,9 @@
 
 //#include <QDebug>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QVariant>
@@ -40,19 +43,71 @@ QString qtifyName(const QString &key)
     return QString(key).replace(".", "-").replace("_", "-");
 }
 
+// QGSettings::changed reports the key in camel case, e.g. "base-open" as "baseOpen".
+static QString camelCaseName(const QString &gsettingsKey)
+{
+    QString ret;
+    ret.reserve(gsettingsKey.size());
+    bool upper = false;
+    for (const QChar c : gsettingsKey) {
+        if (c == QLatin1Char('-')) {
+            upper = true;
+        } else if (upper) {
+            ret.append(c.toUpper());
+            upper = false;
+        } else {
+            ret.append(c);
+        }
+    }
+    return ret;
+}
+
+// pending options are written to gsettings after no option was changed for this interval.
+static constexpr int ApplyInterval = 100;
 
 class GSettingsBackendPrivate
 {
 public:
     GSettingsBackendPrivate(GSettingsBackend *parent) : q_ptr(parent) {}
 
+    void apply();
+
+    inline QString gsettingsKey(const QString &key) const
+    {
+        auto it = keyToGSettingsKey.constFind(key);
+        return it != keyToGSettingsKey.constEnd() ? it.value() : qtifyName(key);
+    }
+
     QGSettings *gsettings;
-    QMap<QString, QString> keyMap;
+    QTimer *applyTimer = nullptr;
+    // pendingValues is written in the thread of the backend and read by getOption() in any thread.
+    mutable QMutex writeLock;
+
+    // built once from the options of DSettings.
+    QHash<QString, QString> keyToGSettingsKey;
+    QHash<QString, QString> gsettingsKeyToKey;
+
+    QVariantMap pendingValues;
 
     GSettingsBackend *q_ptr;
     Q_DECLARE_PUBLIC(GSettingsBackend)
 };
 
+void GSettingsBackendPrivate::apply()
+{
+    writeLock.lock();
+    const QVariantMap values = pendingValues;
+    pendingValues.clear();
+    writeLock.unlock();
+
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        const QString &key = gsettingsKey(it.key());
+        if (it.value() != gsettings->get(key)) {
+            gsettings->set(key, it.value());
+        }
+    }
+}
+
 /*!
 @~english
   @class Dtk::Core::GSettingsBackend
@@ -62,6 +117,9 @@ public:
   You should generate gsetting schema with /usr/lib/x86_64-linux-gnu/libdtk-$$VERSION/DCore/bin/dtk-settings.
   
   You can find this tool from libdtkcore-bin. use /usr/lib/x86_64-linux-gnu/libdtk-$$VERSION/DCore/bin/dtk-settings -h for help.
+
+  Options set in a short burst are collected and applied to gsettings together,
+  only the last value of every key is written.
  */
 
 GSettingsBackend::GSettingsBackend(DSettings *settings, QObject *parent) :
@@ -74,15 +132,35 @@ GSettingsBackend::GSettingsBackend(DSettings *settings, QObject *parent) :
     auto id = gsettingsMeta.value("id").toString();
     auto path = gsettingsMeta.value("path").toString();
 
-    for (QString key : settings->keys()) {
-        auto gsettingsKey = QString(key).replace(".", "-").replace("_", "-");
-        d->keyMap.insert(gsettingsKey, key);
+    const QStringList &keys = settings->keys();
+    d->keyToGSettingsKey.reserve(keys.size());
+    d->gsettingsKeyToKey.reserve(keys.size() * 2);
+    for (const QString &key : keys) {
+        const QString &gsettingsKey = qtifyName(key);
+        d->keyToGSettingsKey.insert(key, gsettingsKey);
+        d->gsettingsKeyToKey.insert(gsettingsKey, key);
+        d->gsettingsKeyToKey.insert(camelCaseName(gsettingsKey), key);
     }
 
     d->gsettings = new QGSettings(id.toUtf8(), path.toUtf8(), this);
 
+    d->applyTimer = new QTimer(this);
+    d->applyTimer->setSingleShot(true);
+    d->applyTimer->setInterval(ApplyInterval);
+    connect(d->applyTimer, &QTimer::timeout, this, [d]() {
+        d->apply();
+    });
+
     connect(d->gsettings, &QGSettings::changed, this, [ = ](const QString & key) {
-        auto dk = d->keyMap.value(unqtifyName(key));
+        auto it = d->gsettingsKeyToKey.constFind(key);
+        const QString &dk = it != d->gsettingsKeyToKey.constEnd() ? it.value()
+                                                                   : d->gsettingsKeyToKey.value(unqtifyName(key));
+        d->writeLock.lock();
+        const bool isPending = d->pendingValues.contains(dk);
+        d->writeLock.unlock();
+        // a newer value will be written, don't override it with the old one.
+        if (isPending)
+            return;
 //        qDebug() << "gsetting change" << key << d->gsettings->get(key);
         Q_EMIT optionChanged(dk, d->gsettings->get(key));
     });
@@ -91,7 +169,8 @@ GSettingsBackend::GSettingsBackend(DSettings *settings, QObject *parent) :
 
 GSettingsBackend::~GSettingsBackend()
 {
-
+    Q_D(GSettingsBackend);
+    d->apply();
 }
 
 /*!
@@ -107,27 +186,52 @@ QStringList GSettingsBackend::keys() const
 
 /*!
 @~english
-  @brief Get value of key.
+  @brief Get value of key, the value isn't applied to gsettings yet is returned first.
   @return Return the value of the given \a key.
  */
 QVariant GSettingsBackend::getOption(const QString &key) const
 {
     Q_D(const GSettingsBackend);
-    return d->gsettings->get(qtifyName(key));
+    {
+        QMutexLocker locker(&d->writeLock);
+        auto it = d->pendingValues.constFind(key);
+        if (it != d->pendingValues.constEnd())
+            return it.value();
+    }
+
+    return d->gsettings->get(d->gsettingsKey(key));
 }
 
 /*!
 @~english
   @brief Set value to gsettings
-  Use the \a key to save the \a value.
+  Use the \a key to save the \a value, the value is applied together with other changes later.
+  @sa doSync()
  */
 void GSettingsBackend::doSetOption(const QString &key, const QVariant &value)
 {
     Q_D(GSettingsBackend);
-    if (value != d->gsettings->get(qtifyName(key))) {
-//        qDebug() << "doSetOption" << key << d->gsettings->get(qtifyName(key));
-        d->gsettings->set(qtifyName(key), value);
-    }
+//    qDebug() << "doSetOption" << key << value;
+    d->writeLock.lock();
+    d->pendingValues.insert(key, value);
+    d->writeLock.unlock();
+    d->applyTimer->start();
+}
+
+/*!
+@~english
+  @brief Set all \a values to gsettings at once.
+  @sa DSettings::commit()
+ */
+void GSettingsBackend::doSetOptions(const QVariantMap &values)
+{
+    Q_D(GSettingsBackend);
+    d->writeLock.lock();
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+        d->pendingValues.insert(it.key(), it.value());
+    d->writeLock.unlock();
+    d->applyTimer->stop();
+    d->apply();
 }
 
 /*!
@@ -136,7 +240,9 @@ void GSettingsBackend::doSetOption(const QString &key, const QVariant &value)
  */
 void GSettingsBackend::doSync()
 {
-    Q_EMIT sync();
+    Q_D(GSettingsBackend);
+    d->applyTimer->stop();
+    d->apply();
 }
 
 DCORE_END_NAMESPACE
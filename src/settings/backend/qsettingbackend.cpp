@@ -98,6 +98,26 @@ void QSettingBackend::doSetOption(const QString &key, const QVariant &value)
     d->writeLock.unlock();
 }
 
+/*!
+@~english
+  @brief Set all \a values to QSettings and write them to disk at once
+  @sa DSettings::commit()
+ */
+void QSettingBackend::doSetOptions(const QVariantMap &values)
+{
+    Q_D(QSettingBackend);
+    d->writeLock.lock();
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        d->settings->beginGroup(it.key());
+        if (d->settings->value("value") != it.value()) {
+            d->settings->setValue("value", it.value());
+        }
+        d->settings->endGroup();
+    }
+    d->settings->sync();
+    d->writeLock.unlock();
+}
+
 /*!
 @~english
   @brief Trigger DSettings to save option value to QSettings
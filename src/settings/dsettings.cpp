@@ -23,6 +23,8 @@ class DSettingsPrivate
 public:
     DSettingsPrivate(DSettings *parent) : q_ptr(parent) {}
 
+    void writeValues(const QVariantMap &values);
+
     DSettingsBackend            *backend = nullptr;
     QJsonObject                 meta;
     QMap <QString, OptionPtr>   options;
@@ -30,10 +32,30 @@ public:
     QMap<QString, GroupPtr>     childGroups;
     QList<QString>              childGroupKeys;
 
+    int                         updateDepth = 0;
+    QVariantMap                 pendingValues;
+
     DSettings *q_ptr;
     Q_DECLARE_PUBLIC(DSettings)
 };
 
+void DSettingsPrivate::writeValues(const QVariantMap &values)
+{
+    if (!backend) {
+        qWarning() << "backend was not setted..!";
+        return;
+    }
+
+    // backend which provide `doSetOptions(QVariantMap)` can store all values with one write.
+    if (values.size() > 1 && backend->metaObject()->indexOfMethod("doSetOptions(QVariantMap)") >= 0) {
+        QMetaObject::invokeMethod(backend, "doSetOptions", Qt::QueuedConnection, Q_ARG(QVariantMap, values));
+        return;
+    }
+
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+        Q_EMIT backend->setOption(it.key(), it.value());
+}
+
 
 /*!
 @~english
@@ -388,6 +410,63 @@ void DSettings::setOption(const QString &key, const QVariant &value)
     option(key)->setValue(value);
 }
 
+/*!
+@~english
+  @brief Start a batch update, changes of options are collected until the matching commit().
+
+  Inside a batch, DSettings does not emit valueChanged() and does not write every option
+  to the backend, the changes are written and notified at once when commit() is called.
+  Calls can be nested, only the outermost commit() takes effect.
+  @sa commit(), valuesChanged()
+ */
+void DSettings::beginUpdate()
+{
+    Q_D(DSettings);
+    ++d->updateDepth;
+}
+
+/*!
+@~english
+  @brief Finish a batch update started by beginUpdate().
+
+  All values changed in the batch are written to the backend with a single request.
+  valueChanged() is emitted for every changed option, so that existing receivers see the
+  changes, then valuesChanged() is emitted once with the changed keys and values.
+  @sa beginUpdate(), isUpdating()
+ */
+void DSettings::commit()
+{
+    Q_D(DSettings);
+    if (d->updateDepth <= 0) {
+        qWarning() << "commit was called without beginUpdate..!";
+        return;
+    }
+
+    if (--d->updateDepth > 0)
+        return;
+
+    if (d->pendingValues.isEmpty())
+        return;
+
+    const QVariantMap values = d->pendingValues;
+    d->pendingValues.clear();
+
+    d->writeValues(values);
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+        Q_EMIT valueChanged(it.key(), it.value());
+    Q_EMIT valuesChanged(values);
+}
+
+/*!
+@~english
+  @brief Return true if a batch update started by beginUpdate() is not committed yet.
+ */
+bool DSettings::isUpdating() const
+{
+    Q_D(const DSettings);
+    return d->updateDepth > 0;
+}
+
 void DSettings::sync()
 {
     Q_D(DSettings);
@@ -405,11 +484,13 @@ void DSettings::reset()
 {
     Q_D(DSettings);
 
+    beginUpdate();
     for (auto option : d->options) {
         if (option->canReset()) {
             setOption(option->key(), option->defaultValue());
         }
     }
+    commit();
 
     if (!d->backend) {
         qWarning() << "backend was not setted..!";
@@ -440,6 +521,11 @@ void DSettings::parseJson(const QByteArray &json)
         d->options.insert(option->key(), option);
         connect(option.data(), &DSettingsOption::valueChanged,
         this, [ = ](QVariant value) {
+            if (d->updateDepth > 0) {
+                d->pendingValues.insert(option->key(), value);
+                return;
+            }
+
             if (d->backend) {
                 Q_EMIT d->backend->setOption(option->key(), value);
             } else {
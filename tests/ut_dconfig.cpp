@@ -6,6 +6,7 @@
 #include <QBuffer>
 #include <QDir>
 #include <QDebug>
+#include <QCoreApplication>
 
 #include <gtest/gtest.h>
 #include "test_helper.hpp"
@@ -207,6 +208,25 @@ TEST_F(ut_DConfig, DSettingsDConfigBackend)
     }
 }
 
+TEST_F(ut_DConfig, DSettingsDConfigBackendSync)
+{
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    {
+        DSettingsDConfigBackend backend(FILE_NAME);
+        Q_EMIT backend.setOption("key2", "127");
+        Q_EMIT backend.setOption("key2", "128");
+        QCoreApplication::processEvents();
+        // pending value is visible before it's written to DConfig.
+        ASSERT_EQ(backend.getOption("key2").toString(), QString("128"));
+        // pending value is written when backend is destroyed.
+    }
+
+    {
+        DConfig config(FILE_NAME);
+        ASSERT_EQ(config.value("key2").toString(), QString("128"));
+    }
+}
+
 TEST_F(ut_DConfig, isDefaultValue) {
 
     FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
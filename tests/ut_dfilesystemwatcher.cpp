@@ -4,9 +4,15 @@
 
 #include <gtest/gtest.h>
 #include <QDir>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QThread>
+
+#include <unistd.h>
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
 #include <filesystem>  //Avoid changing the access control of the standard library
 #endif
+#include "dfilesystemwatcher_linux_p.h"
 #define private public
 #include "filesystem/dfilesystemwatcher.h"
 #undef private
@@ -94,3 +100,307 @@ TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherRemovePaths)
     ASSERT_FALSE(dirs1.contains("/tmp/etc0"));
     ASSERT_FALSE(dirs1.contains("/tmp/etc1"));
 }
+
+static void appendInotifyEvent(QByteArray &buffer, int wd, quint32 mask, quint32 cookie, const QByteArray &name)
+{
+    // the name is padded with zeros like the kernel does.
+    const quint32 len = name.isEmpty() ? 0 : (name.size() + sizeof(inotify_event)) & ~(sizeof(inotify_event) - 1);
+    inotify_event event{wd, mask, cookie, len};
+    buffer.append(reinterpret_cast<const char *>(&event), sizeof(event));
+    buffer.append(name);
+    buffer.append(QByteArray(int(len) - name.size(), '\0'));
+}
+
+TEST_F(ut_DFileSystemWatcher, testInotifyWatchTable)
+{
+    DInotifyWatchTable watches;
+    // more than the initial capacity, some of them collide.
+    for (int wd = 1; wd <= 100; ++wd)
+        watches.insert(wd * 16, wd % 2, QString("/tmp/%1").arg(wd));
+    watches.insert(32, false, "/tmp/link");
+    ASSERT_EQ(watches.size(), 100);
+
+    const DInotifyWatchTable::Watch *watch = watches.find(32);
+    ASSERT_TRUE(watch);
+    ASSERT_FALSE(watch->isDirectory);
+    const DInotifyWatchTable::Paths &paths = watches.paths(32);
+    ASSERT_EQ(paths.size(), 2);
+    ASSERT_EQ(paths.at(0), "/tmp/2");
+    ASSERT_EQ(paths.at(1), "/tmp/link");
+    ASSERT_FALSE(watches.find(33));
+    ASSERT_FALSE(watches.find(0));
+
+    // the last path removes the watch.
+    ASSERT_FALSE(watches.remove(32, "/tmp/2"));
+    ASSERT_EQ(watches.find(32)->path, "/tmp/link");
+    ASSERT_TRUE(watches.remove(32, "/tmp/link"));
+    ASSERT_FALSE(watches.find(32));
+    for (int wd = 1; wd <= 100; wd += 2)
+        ASSERT_TRUE(watches.remove(wd * 16, QString("/tmp/%1").arg(wd)));
+    ASSERT_EQ(watches.size(), 49);
+
+    // the watches after a removed one in a probe sequence are still found.
+    for (int wd = 1; wd <= 100; ++wd) {
+        if (wd == 2 || wd % 2)
+            ASSERT_FALSE(watches.find(wd * 16)) << wd;
+        else
+            ASSERT_EQ(watches.find(wd * 16)->path, QString("/tmp/%1").arg(wd));
+    }
+}
+
+TEST_F(ut_DFileSystemWatcher, testInotifyEventBatch)
+{
+    DInotifyWatchTable watches;
+    watches.insert(1, true, "/tmp/etc0");
+    watches.insert(2, false, "/tmp/etc1/file");
+
+    QByteArray buffer;
+    appendInotifyEvent(buffer, 1, IN_CREATE, 0, "a");
+    appendInotifyEvent(buffer, 1, IN_MODIFY, 0, "a");
+    appendInotifyEvent(buffer, 1, IN_MODIFY, 0, "a");
+    appendInotifyEvent(buffer, 1, IN_MODIFY, 0, "b");
+    appendInotifyEvent(buffer, 2, IN_MODIFY, 0, QByteArray());
+    appendInotifyEvent(buffer, 2, IN_MODIFY, 0, QByteArray());
+    // not watched
+    appendInotifyEvent(buffer, 3, IN_MODIFY, 0, "c");
+    appendInotifyEvent(buffer, 1, IN_MOVED_FROM, 7, "a");
+    appendInotifyEvent(buffer, 1, IN_MOVED_TO, 7, "d");
+
+    DInotifyEventBatch batch(watches);
+    batch.parse(buffer.constData(), buffer.size());
+
+    ASSERT_EQ(batch.events.size(), 5);
+    ASSERT_EQ(batch.duplicateCount, 2);
+    ASSERT_EQ(batch.events.at(0)->mask, quint32(IN_CREATE));
+    ASSERT_STREQ(batch.events.at(2)->name, "b");
+    ASSERT_EQ(batch.events.at(3)->wd, 2);
+    ASSERT_EQ(batch.events.at(4)->mask, quint32(IN_MOVED_FROM));
+
+    int id = 0;
+    ASSERT_EQ(batch.paths(1, &id).size(), 1);
+    ASSERT_EQ(batch.paths(1, &id).at(0), "/tmp/etc0");
+    ASSERT_EQ(id, -1);
+    ASSERT_EQ(batch.paths(2, &id).size(), 1);
+    ASSERT_EQ(batch.paths(2, &id).at(0), "/tmp/etc1/file");
+    ASSERT_EQ(id, 2);
+
+    // the move target is only kept by cookie.
+    ASSERT_EQ(batch.cookieToFilePath.values(7), QList<QString>{"/tmp/etc0"});
+    ASSERT_EQ(batch.cookieToFileName.value(7), QString("d"));
+    ASSERT_TRUE(batch.hasMoveFromByCookie.contains(7));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherAddRecursivePath)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("a/b"));
+
+    QList<QPair<QString, QString>> created;
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileCreated, fileSystemWatcher,
+                     [&created](const QString &path, const QString &name) {
+        created.append({path, name});
+    });
+
+    ASSERT_TRUE(fileSystemWatcher->addRecursivePath(dir.path()));
+    ASSERT_TRUE(fileSystemWatcher->directories().contains(dir.path()));
+    // the subdirectories are added in the background.
+    ASSERT_TRUE(QTest::qWaitFor([&]() {
+        return fileSystemWatcher->directories().contains(dir.filePath("a/b"));
+    }, 3000));
+
+    QFile file(dir.filePath("a/b/f"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&]() {
+        return created.contains({dir.filePath("a/b"), "f"});
+    }, 3000));
+
+    // a new directory is watched, the file created in it right away is reported.
+    ASSERT_TRUE(QDir(dir.path()).mkpath("a/c"));
+    QFile early(dir.filePath("a/c/g"));
+    ASSERT_TRUE(early.open(QIODevice::WriteOnly));
+    early.close();
+    ASSERT_TRUE(QTest::qWaitFor([&]() {
+        return created.contains({dir.filePath("a"), "c"}) && created.contains({dir.filePath("a/c"), "g"});
+    }, 3000));
+    ASSERT_TRUE(fileSystemWatcher->directories().contains(dir.filePath("a/c")));
+
+    // a removed directory isn't watched anymore.
+    ASSERT_TRUE(QDir(dir.filePath("a/c")).removeRecursively());
+    ASSERT_TRUE(QTest::qWaitFor([&]() {
+        return !fileSystemWatcher->directories().contains(dir.filePath("a/c"));
+    }, 3000));
+    ASSERT_TRUE(fileSystemWatcher->directories().contains(dir.filePath("a/b")));
+
+    fileSystemWatcher->removePath(dir.path());
+    ASSERT_TRUE(fileSystemWatcher->directories().isEmpty());
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherReaderThread)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(fileSystemWatcher->addPath(dir.path()));
+
+    fileSystemWatcher->setReaderThreadEnabled(true);
+    ASSERT_TRUE(fileSystemWatcher->isReaderThreadEnabled());
+
+    QStringList created;
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileCreated, fileSystemWatcher,
+                     [&created](const QString &, const QString &name) {
+        created.append(name);
+    });
+
+    // the thread of the watcher is busy while the files are created.
+    for (int i = 0; i < 100; ++i) {
+        QFile file(dir.filePath(QString::number(i)));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+    QThread::msleep(100);
+    ASSERT_TRUE(fileSystemWatcher->d_func()->reader->m_queuedSize.load() > 0);
+
+    ASSERT_TRUE(QTest::qWaitFor([&created]() {
+        return created.size() >= 100;
+    }, 3000));
+    ASSERT_EQ(created.first(), "0");
+    ASSERT_EQ(created.last(), "99");
+
+    // the notifier reads the events again.
+    fileSystemWatcher->setReaderThreadEnabled(false);
+    ASSERT_FALSE(fileSystemWatcher->isReaderThreadEnabled());
+    QFile file(dir.filePath("last"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(QTest::qWaitFor([&created]() {
+        return created.contains("last");
+    }, 3000));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherOverflowRecovery)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    for (const char *name : {"deleted", "moved", "modified"}) {
+        QFile file(dir.filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+    ASSERT_TRUE(fileSystemWatcher->addPath(dir.path()));
+    fileSystemWatcher->setOverflowRecoveryEnabled(true);
+    ASSERT_TRUE(fileSystemWatcher->isOverflowRecoveryEnabled());
+
+    DFileSystemWatcherPrivate *d = fileSystemWatcher->d_func();
+    ASSERT_TRUE(QTest::qWaitFor([d, &dir]() {
+        return d->snapshots.contains(dir.path());
+    }, 3000));
+
+    QStringList events;
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileCreated, fileSystemWatcher,
+                     [&events](const QString &, const QString &name) { events << "created " + name; });
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileDeleted, fileSystemWatcher,
+                     [&events](const QString &, const QString &name) { events << "deleted " + name; });
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileModified, fileSystemWatcher,
+                     [&events](const QString &, const QString &name) { events << "modified " + name; });
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileMoved, fileSystemWatcher,
+                     [&events](const QString &, const QString &fromName, const QString &, const QString &toName) {
+        events << "moved " + fromName + ' ' + toName;
+    });
+
+    // the events are lost like in an overflow.
+    d->notifier.setEnabled(false);
+    QFile created(dir.filePath("created"));
+    ASSERT_TRUE(created.open(QIODevice::WriteOnly));
+    created.close();
+    ASSERT_TRUE(QFile::remove(dir.filePath("deleted")));
+    ASSERT_TRUE(QFile::rename(dir.filePath("moved"), dir.filePath("renamed")));
+    QFile modified(dir.filePath("modified"));
+    ASSERT_TRUE(modified.open(QIODevice::WriteOnly));
+    modified.write("hello");
+    modified.close();
+
+    char buffer[4096];
+    while (read(d->inotifyFd, buffer, sizeof(buffer)) > 0) { }
+    d->notifier.setEnabled(true);
+
+    const inotify_event overflow{-1, IN_Q_OVERFLOW, 0, 0};
+    d->processEvents(reinterpret_cast<const char *>(&overflow), sizeof(overflow));
+
+    ASSERT_TRUE(QTest::qWaitFor([&events]() {
+        return events.size() >= 4;
+    }, 3000));
+    ASSERT_TRUE(events.contains("created created"));
+    ASSERT_TRUE(events.contains("deleted deleted"));
+    ASSERT_TRUE(events.contains("moved moved renamed"));
+    ASSERT_TRUE(events.contains("modified modified"));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherWatchBudget)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString &path = dir.filePath("file");
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    fileSystemWatcher->setWatchBudget(1);
+    ASSERT_EQ(fileSystemWatcher->watchBudget(), 1);
+    ASSERT_TRUE(fileSystemWatcher->addPath(path));
+    ASSERT_EQ(fileSystemWatcher->watchCount(), 1);
+
+    // the directory takes the watch of the file, which is polled.
+    ASSERT_TRUE(fileSystemWatcher->addPath(dir.path()));
+    ASSERT_EQ(fileSystemWatcher->watchCount(), 1);
+    ASSERT_EQ(fileSystemWatcher->polledPaths(), QStringList{path});
+    ASSERT_TRUE(fileSystemWatcher->files().contains(path));
+    ASSERT_TRUE(fileSystemWatcher->directories().contains(dir.path()));
+
+    QStringList modified;
+    QObject::connect(fileSystemWatcher, &DFileSystemWatcher::fileModified, fileSystemWatcher,
+                     [&modified](const QString &path, const QString &name) {
+        modified << (name.isEmpty() ? path : name);
+    });
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("hello");
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&modified, &path]() {
+        return modified.contains(path);
+    }, 3000));
+
+    // the freed watch is used by the polled file.
+    ASSERT_TRUE(fileSystemWatcher->removePath(dir.path()));
+    ASSERT_TRUE(fileSystemWatcher->polledPaths().isEmpty());
+    ASSERT_EQ(fileSystemWatcher->watchCount(), 1);
+    ASSERT_TRUE(fileSystemWatcher->removePath(path));
+    ASSERT_EQ(fileSystemWatcher->watchCount(), 0);
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherRecursiveWatchBudget)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    ASSERT_TRUE(QDir(dir.path()).mkpath("a/b"));
+
+    // the root takes the only watch, the sweep polls the subdirectories.
+    fileSystemWatcher->setWatchBudget(1);
+    ASSERT_TRUE(fileSystemWatcher->addRecursivePath(dir.path()));
+    ASSERT_TRUE(QTest::qWaitFor([&]() {
+        return fileSystemWatcher->directories().contains(dir.filePath("a/b"));
+    }, 3000));
+    ASSERT_EQ(fileSystemWatcher->watchCount(), 1);
+    const QStringList &polled = fileSystemWatcher->polledPaths();
+    ASSERT_TRUE(polled.contains(dir.filePath("a")));
+    ASSERT_TRUE(polled.contains(dir.filePath("a/b")));
+
+    fileSystemWatcher->removePath(dir.path());
+    ASSERT_EQ(fileSystemWatcher->watchCount(), 0);
+}
@@ -6,9 +6,14 @@
 #include <QDir>
 #include <QSignalSpy>
 #include <QTest>
+#include <QThread>
 #include <QUrl>
 #include "filesystem/dfilewatcher.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 DCORE_USE_NAMESPACE
 
 
@@ -192,3 +197,164 @@ TEST_F(ut_DFileWatcher, testDFileSystemWatcherFileClosed)
     }, 1000));
     ASSERT_TRUE(spy.count() >= 1);
 }
+
+TEST_F(ut_DFileWatcher, testDFileWatcherDispatchToWatchedPath)
+{
+    if (!fileWatcher->startWatcher()) return;
+
+    QFile other("/tmp/etc/test1");
+    ASSERT_TRUE(other.open(QIODevice::WriteOnly | QIODevice::Text));
+    other.close();
+    DFileWatcher otherWatcher("/tmp/etc/test1");
+    ASSERT_TRUE(otherWatcher.startWatcher());
+    DFileWatcher directoryWatcher("/tmp/etc");
+    ASSERT_TRUE(directoryWatcher.startWatcher());
+
+    QSignalSpy spy(fileWatcher, &DBaseFileWatcher::fileModified);
+    QSignalSpy otherSpy(&otherWatcher, &DBaseFileWatcher::fileModified);
+    QSignalSpy directorySpy(&directoryWatcher, &DBaseFileWatcher::fileModified);
+    QFile file("/tmp/etc/test");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write("hello");
+    file.close();
+
+    ASSERT_TRUE(QTest::qWaitFor([&spy, &directorySpy](){
+        return spy.count() >= 1 && directorySpy.count() >= 1;
+    }, 1000));
+    ASSERT_EQ(otherSpy.count(), 0);
+    ASSERT_EQ(spy.first().first().toUrl(), QUrl::fromLocalFile("/tmp/etc/test"));
+
+    // a stopped watcher gets nothing.
+    ASSERT_TRUE(fileWatcher->stopWatcher());
+    spy.clear();
+    directorySpy.clear();
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write("world");
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&directorySpy](){
+        return directorySpy.count() >= 1;
+    }, 1000));
+    ASSERT_EQ(spy.count(), 0);
+}
+
+TEST_F(ut_DFileWatcher, testDFileWatcherCoalescingWindow)
+{
+    if (!fileWatcher->startWatcher()) return;
+
+    fileWatcher->setCoalescingWindow(300);
+    ASSERT_EQ(fileWatcher->coalescingWindow(), 300);
+    ASSERT_EQ(fileWatcher->coalescingDelivery(), DBaseFileWatcher::TrailingDelivery);
+
+    QSignalSpy spy(fileWatcher, &DBaseFileWatcher::fileModified);
+    QSignalSpy changedSpy(fileWatcher, &DBaseFileWatcher::fileChanged);
+    QFile file("/tmp/etc/test");
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        file.write("hello");
+        file.close();
+    }
+
+    ASSERT_TRUE(QTest::qWaitFor([&changedSpy](){
+        return changedSpy.count() >= 1;
+    }, 5000));
+    // let the burst settle, its changes are merged into a few deliveries.
+    QTest::qWait(1000);
+    ASSERT_LT(changedSpy.count(), 10);
+    ASSERT_EQ(spy.count(), changedSpy.count());
+    const auto changes = changedSpy.first().at(1).value<DBaseFileWatcher::ChangeFlags>();
+    ASSERT_TRUE(changes.testFlag(DBaseFileWatcher::Modified));
+    ASSERT_TRUE(changes.testFlag(DBaseFileWatcher::Closed));
+
+    // the first change of a burst is reported, without waiting for the others.
+    fileWatcher->setCoalescingWindow(300, DBaseFileWatcher::LeadingDelivery);
+    changedSpy.clear();
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("world");
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&changedSpy](){
+        return changedSpy.count() >= 1;
+    }, 5000));
+    ASSERT_TRUE(changedSpy.first().at(1).value<DBaseFileWatcher::ChangeFlags>().testFlag(DBaseFileWatcher::Modified));
+}
+
+TEST_F(ut_DFileWatcher, testDFileWatcherSharedAncestorWatches)
+{
+    if (!fileWatcher->startWatcher()) return;
+
+    ASSERT_TRUE(QDir().mkpath("/tmp/etc/trie/sub"));
+    QFile file("/tmp/etc/trie/sub/file");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.close();
+    DFileWatcher watcher("/tmp/etc/trie/sub/file");
+    ASSERT_TRUE(watcher.startWatcher());
+    DFileWatcher directoryWatcher("/tmp/etc/trie");
+    ASSERT_TRUE(directoryWatcher.startWatcher());
+
+    // stopping a watcher keeps the ancestors the others still need.
+    ASSERT_TRUE(directoryWatcher.stopWatcher());
+    ASSERT_TRUE(directoryWatcher.startWatcher());
+
+    // moving an ancestor away deletes the watched file.
+    QSignalSpy spy(&watcher, &DBaseFileWatcher::fileDeleted);
+    QSignalSpy otherSpy(fileWatcher, &DBaseFileWatcher::fileDeleted);
+    ASSERT_TRUE(QDir().rename("/tmp/etc/trie/sub", "/tmp/etc/trie/sub1"));
+    ASSERT_TRUE(QTest::qWaitFor([&spy](){
+        return spy.count() >= 1;
+    }, 1000));
+    ASSERT_EQ(spy.first().first().toUrl(), QUrl::fromLocalFile("/tmp/etc/trie/sub/file"));
+    ASSERT_EQ(otherSpy.count(), 0);
+
+    ASSERT_TRUE(watcher.stopWatcher());
+    ASSERT_TRUE(directoryWatcher.stopWatcher());
+    QDir("/tmp/etc/trie").removeRecursively();
+}
+
+TEST_F(ut_DFileWatcher, testDFileWatcherOtherThreads)
+{
+    if (!fileWatcher->startWatcher()) return;
+
+    // watchers of the same paths started and stopped on several threads at once.
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (int n = 0; n < 50; ++n) {
+                DFileWatcher watcher(n % 2 ? "/tmp/etc/test" : "/tmp/etc");
+                watcher.startWatcher();
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    // the watches of fileWatcher are still there.
+    QSignalSpy spy(fileWatcher, &DBaseFileWatcher::fileModified);
+
+    // a watcher gets its signals in its own thread.
+    QThread thread;
+    thread.start();
+    auto watcher = new DFileWatcher("/tmp/etc/test");
+    watcher->moveToThread(&thread);
+    std::atomic<QThread *> emittedIn{nullptr};
+    QObject::connect(watcher, &DBaseFileWatcher::fileModified, watcher, [&emittedIn] {
+        emittedIn = QThread::currentThread();
+    }, Qt::DirectConnection);
+    bool started = false;
+    QMetaObject::invokeMethod(watcher, [watcher, &started] {
+        started = watcher->startWatcher();
+    }, Qt::BlockingQueuedConnection);
+    ASSERT_TRUE(started);
+
+    QFile file("/tmp/etc/test");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write("hello");
+    file.close();
+
+    ASSERT_TRUE(QTest::qWaitFor([&spy, &emittedIn](){
+        return spy.count() >= 1 && emittedIn.load();
+    }, 1000));
+    ASSERT_EQ(emittedIn.load(), &thread);
+
+    QMetaObject::invokeMethod(watcher, [watcher] { delete watcher; }, Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+}
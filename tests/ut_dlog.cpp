@@ -8,7 +8,28 @@
 #include "dpathbuf.h"
 #include "dstandardpaths.h"
 #include "test_helper.hpp"
+#include "AsyncAppender.h"
+#include "LogFormatter.h"
+#include "LogCompressor.h"
+#include "BinaryAppender.h"
+#include "FlightRecorderAppender.h"
+#include "LogRateLimiter.h"
+#include "LoggingRules.h"
+#include "LogMetrics.h"
+#include "EarlyLogBuffer.h"
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <AbstractStringAppender.h>
 #include <gtest/gtest.h>
+#include <QBuffer>
+#include <QDeadlineTimer>
+#include <QTest>
+#include <QThread>
+#include <QtEndian>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 DCORE_USE_NAMESPACE
 
@@ -37,3 +58,689 @@ TEST(ut_DLogManager, testSetInvalidLogPath)
     // set log file path to a dir is not supported
     ASSERT_NE(DLogManager::getlogFilePath(), tmp);
 }
+
+// records the messages, slow enough to fill the queue if asked.
+class RecordingAppender : public AbstractAppender
+{
+public:
+    // `sink` receives the messages as well, it outlives the appender.
+    explicit RecordingAppender(int delay = 0, QStringList *sink = nullptr)
+        : delay(delay), sink(sink) {}
+
+    QStringList messages() const
+    {
+        QMutexLocker locker(&mutex);
+        return m_messages;
+    }
+
+    static void log(AbstractAppender &appender, const QString &message)
+    {
+        appender.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, QString(), message);
+    }
+
+protected:
+    void append(const QDateTime &, Logger::LogLevel, const char *, int,
+                const char *, const QString &, const QString &message) override
+    {
+        if (delay > 0)
+            QThread::msleep(delay);
+        QMutexLocker locker(&mutex);
+        m_messages << message;
+        if (sink)
+            *sink << message;
+    }
+
+private:
+    int delay;
+    QStringList *sink;
+    mutable QMutex mutex;
+    QStringList m_messages;
+};
+
+TEST(ut_AsyncAppender, testWriteInOrder)
+{
+    auto target = new RecordingAppender;
+    AsyncAppender appender(target, DLogManager::BlockWhenFull, 4);
+
+    constexpr int Count = 1000;
+    for (int i = 0; i < Count; ++i)
+        RecordingAppender::log(appender, QString::number(i));
+    appender.flush();
+
+    const QStringList &messages = target->messages();
+    ASSERT_EQ(messages.size(), Count);
+    for (int i = 0; i < Count; ++i)
+        ASSERT_EQ(messages.at(i), QString::number(i));
+    ASSERT_EQ(appender.droppedCount(), 0u);
+}
+
+TEST(ut_AsyncAppender, testMultipleProducers)
+{
+    auto target = new RecordingAppender;
+    AsyncAppender appender(target, DLogManager::BlockWhenFull, 16);
+
+    constexpr int ThreadCount = 4;
+    constexpr int Count = 500;
+    QList<QThread *> threads;
+    for (int t = 0; t < ThreadCount; ++t) {
+        threads << QThread::create([&appender, t] {
+            for (int i = 0; i < Count; ++i)
+                RecordingAppender::log(appender, QString("%1-%2").arg(t).arg(i));
+        });
+        threads.last()->start();
+    }
+    for (auto thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+    appender.flush();
+
+    ASSERT_EQ(target->messages().size(), ThreadCount * Count);
+}
+
+TEST(ut_AsyncAppender, testDropWhenFull)
+{
+    auto target = new RecordingAppender(5);
+    AsyncAppender appender(target, DLogManager::DropWhenFull, 2);
+
+    constexpr int Count = 64;
+    for (int i = 0; i < Count; ++i)
+        RecordingAppender::log(appender, QString::number(i));
+    appender.flush();
+
+    ASSERT_GT(appender.droppedCount(), 0u);
+    ASSERT_EQ(quint64(target->messages().size()) + appender.droppedCount(), quint64(Count));
+}
+
+TEST(ut_AsyncAppender, testCountDroppedRecords)
+{
+    auto target = new RecordingAppender(5);
+    AsyncAppender appender(target, DLogManager::DropAndCountWhenFull, 2);
+
+    constexpr int Count = 64;
+    for (int i = 0; i < Count; ++i)
+        RecordingAppender::log(appender, QString::number(i));
+    appender.flush();
+
+    // the count of dropped records is reported once the queue is drained.
+    ASSERT_TRUE(QTest::qWaitFor([target] {
+        return !target->messages().filter("records were dropped").isEmpty();
+    }, 1000));
+}
+
+TEST(ut_AsyncAppender, testFlushOnDestroy)
+{
+    QStringList messages;
+    {
+        AsyncAppender appender(new RecordingAppender(1, &messages), DLogManager::BlockWhenFull, 64);
+        // don't flush, destroying the appender writes the queued records.
+        for (int i = 0; i < 32; ++i)
+            RecordingAppender::log(appender, QString::number(i));
+    }
+    ASSERT_EQ(messages.size(), 32);
+}
+
+// exposes the formatting of AbstractStringAppender.
+class StringAppender : public AbstractStringAppender
+{
+public:
+    QString format(const QDateTime &time, Logger::LogLevel level, const QString &message)
+    {
+        return formattedString(time, level, __FILE__, 42, Q_FUNC_INFO, "dtk.test", message);
+    }
+
+protected:
+    void append(const QDateTime &, Logger::LogLevel, const char *, int,
+                const char *, const QString &, const QString &) override {}
+};
+
+TEST(ut_LogFormatter, testSameAsStringAppender)
+{
+    const QStringList formats {
+        "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}",
+        "%{time} %{Type} %{typeOne}%{TypeOne} <%{category}> %{message:10}|",
+        "%{time}{HH:mm:ss} 100%% %{unknown} %{appname} %{pid} %{message}",
+        "%{time}{'z' zzz} %{time}{z} %{File} %{Function} %{message}",
+        "%{time}{process} %{time:12}{boot} %{time}{HH:mm} %{message}",
+    };
+    const QDateTime time = QDateTime::currentDateTime();
+
+    for (const QString &format : formats) {
+        StringAppender appender;
+        appender.setFormat(format);
+        LogFormatter formatter(format);
+
+        for (int level = Logger::Trace; level <= Logger::Fatal; ++level) {
+            auto logLevel = static_cast<Logger::LogLevel>(level);
+            QString expected, actual;
+            // the elapsed times of process and boot may tick between the two calls.
+            for (int attempt = 0; attempt < 3 && (attempt == 0 || actual != expected); ++attempt) {
+                expected = appender.format(time, logLevel, "message");
+                if (expected.endsWith('\n') && !format.endsWith('\n'))
+                    expected.chop(1);
+                actual = formatter.formatted(time, logLevel, __FILE__, 42, Q_FUNC_INFO, "dtk.test", "message");
+            }
+            ASSERT_EQ(actual, expected);
+        }
+    }
+}
+
+TEST(ut_LogFormatter, testCachedTime)
+{
+    LogFormatter formatter("%{time}{yyyy-MM-dd HH:mm:ss.zzz}|%{time}{ss}");
+    QDateTime time = QDateTime::currentDateTime();
+
+    // across the seconds and within a second.
+    for (int step : {0, 1, 7, 99, 893, 1000, 1, 60 * 1000, 24 * 3600 * 1000}) {
+        time = time.addMSecs(step);
+        const QString expected = time.toString("yyyy-MM-dd HH:mm:ss.zzz") + "|" + time.toString("ss");
+        ASSERT_EQ(formatter.formatted(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, QString(), QString()), expected);
+    }
+}
+
+TEST(ut_BinaryAppender, testWriteAndRead)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.blog");
+    const QDateTime time = QDateTime::currentDateTime();
+    constexpr int Count = 100;
+
+    // two segments, the second one starts with empty string tables.
+    for (int segment = 0; segment < 2; ++segment) {
+        BinaryAppender appender(fileName);
+        for (int i = 0; i < Count; ++i) {
+            appender.write(time.addMSecs(i), i % 2 ? Logger::Info : Logger::Warning, __FILE__, i % 3, Q_FUNC_INFO,
+                           i % 2 ? "dtk.test" : QString(), QString("message %1 中文").arg(i));
+        }
+    }
+
+    BinaryLogReader reader(fileName);
+    ASSERT_TRUE(reader.open());
+    BinaryLog::Record record;
+    for (int segment = 0; segment < 2; ++segment) {
+        for (int i = 0; i < Count; ++i) {
+            ASSERT_TRUE(reader.next(record));
+            ASSERT_EQ(record.time, time.addMSecs(i));
+            ASSERT_EQ(record.level, i % 2 ? Logger::Info : Logger::Warning);
+            ASSERT_EQ(record.file, QByteArray(__FILE__));
+            ASSERT_EQ(record.function, QByteArray(Q_FUNC_INFO));
+            ASSERT_EQ(record.line, i % 3);
+            ASSERT_EQ(record.category, i % 2 ? QString("dtk.test") : QString());
+            ASSERT_EQ(record.message, QString("message %1 中文").arg(i));
+        }
+    }
+    ASSERT_FALSE(reader.next(record));
+    ASSERT_TRUE(reader.errorString().isEmpty());
+}
+
+TEST(ut_BinaryAppender, testSmallerThanText)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.blog");
+    LogFormatter formatter("%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}");
+    qint64 textSize = 0;
+    {
+        BinaryAppender appender(fileName);
+        for (int i = 0; i < 1000; ++i) {
+            const QDateTime &time = QDateTime::currentDateTime();
+            appender.write(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, "dtk.test", "value changed");
+            textSize += formatter.formatted(time, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, "dtk.test", "value changed").toUtf8().size() + 1;
+        }
+    }
+    ASSERT_LT(QFileInfo(fileName).size() * 3, textSize);
+}
+
+TEST(ut_BinaryAppender, testFlushInterval)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.blog");
+    BinaryAppender appender(fileName);
+    appender.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, QString(), "buffered");
+
+    // written by the flusher without another record.
+    QDeadlineTimer deadline(5000);
+    while (QFileInfo(fileName).size() == 0 && !deadline.hasExpired())
+        QThread::msleep(50);
+
+    BinaryLogReader reader(fileName);
+    ASSERT_TRUE(reader.open());
+    BinaryLog::Record record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.message, QString("buffered"));
+}
+
+TEST(ut_BinaryAppender, testRotate)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.blog");
+    {
+        BinaryAppender appender(fileName, 1024);
+        for (int i = 0; i < 1000; ++i)
+            appender.write(QDateTime::currentDateTime(), Logger::Error, __FILE__, __LINE__, Q_FUNC_INFO, QString(), "rotate");
+    }
+    ASSERT_TRUE(QFile::exists(fileName + ".1"));
+    ASSERT_LE(QFileInfo(fileName + ".1").size(), 1024 + 256);
+
+    // every file starts with a segment header.
+    BinaryLogReader reader(fileName);
+    ASSERT_TRUE(reader.open());
+    BinaryLog::Record record;
+    ASSERT_TRUE(reader.next(record));
+    ASSERT_EQ(record.message, QString("rotate"));
+}
+
+TEST(ut_FlightRecorderAppender, testLastRecords)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.flight");
+    const QDateTime time = QDateTime::currentDateTime();
+    {
+        // the ring is overwritten many times.
+        FlightRecorderAppender appender(fileName, 4096);
+        ASSERT_TRUE(appender.isMapped());
+        for (int i = 0; i < 1000; ++i)
+            appender.write(time.addMSecs(i), Logger::Info, __FILE__, i, Q_FUNC_INFO, "dtk.test", QString("message %1").arg(i));
+    }
+    ASSERT_EQ(QFileInfo(fileName).size(), FlightRecorder::HeaderSize + 4096);
+
+    FlightRecorderReader reader(fileName);
+    ASSERT_TRUE(reader.open());
+    const auto &last = reader.lastRecords(10);
+    ASSERT_EQ(last.size(), 10);
+    for (int i = 0; i < last.size(); ++i) {
+        ASSERT_EQ(last[i].message, QString("message %1").arg(990 + i));
+        ASSERT_EQ(last[i].time, time.addMSecs(990 + i));
+        ASSERT_EQ(last[i].line, 990 + i);
+        ASSERT_EQ(last[i].file, QByteArray(__FILE__));
+        ASSERT_EQ(last[i].category, QString("dtk.test"));
+    }
+
+    const auto &all = reader.lastRecords();
+    ASSERT_GT(all.size(), 10);
+    ASSERT_LT(all.size(), 1000);
+    ASSERT_EQ(all.last().message, QString("message 999"));
+    ASSERT_EQ(all.first().message, QString("message %1").arg(1000 - all.size()));
+}
+
+TEST(ut_FlightRecorderAppender, testLongFields)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.flight");
+    const QString category(20000, 'c');
+    const QByteArray file(20000, 'f');
+    const QByteArray function(20000, 'g');
+    {
+        // every field alone is longer than the ring.
+        FlightRecorderAppender appender(fileName, 4096);
+        for (int i = 0; i < 10; ++i) {
+            appender.write(QDateTime::currentDateTime(), Logger::Info, file.constData(), i, function.constData(),
+                           category, QString(20000, 'm'));
+        }
+        appender.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, 42, Q_FUNC_INFO, category, "last");
+    }
+
+    FlightRecorderReader reader(fileName);
+    ASSERT_TRUE(reader.open());
+    const auto &records = reader.lastRecords();
+    ASSERT_GE(records.size(), 4);
+    for (const auto &record : records) {
+        ASSERT_TRUE(category.startsWith(record.category));
+        ASSERT_LE(record.category.size() + record.file.size() + record.function.size() + record.message.size(), 4096 / 4);
+    }
+    ASSERT_EQ(records.last().message, QString("last"));
+    ASSERT_EQ(records.last().file, QByteArray(__FILE__));
+    ASSERT_FALSE(records.last().category.isEmpty());
+}
+
+TEST(ut_FlightRecorderAppender, testIncompleteWrite)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.flight");
+    {
+        FlightRecorderAppender appender(fileName, 4096);
+        for (int i = 0; i < 1000; ++i)
+            appender.write(QDateTime::currentDateTime(), Logger::Info, nullptr, 0, nullptr, QString(), QString("message %1").arg(i));
+    }
+
+    // a writer which died after writing a part of a record, the oldest bytes are overwritten.
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    uchar *header = file.map(0, FlightRecorder::HeaderSize + 4096);
+    ASSERT_TRUE(header);
+    const quint64 writePos = qFromLittleEndian<quint64>(header + 16);
+    qToLittleEndian<quint64>(writePos + 200, header + 24);
+    for (quint64 pos = writePos; pos < writePos + 200; ++pos)
+        header[FlightRecorder::HeaderSize + pos % 4096] = 0xff;
+    file.unmap(header);
+    file.close();
+
+    FlightRecorderReader reader(fileName);
+    ASSERT_TRUE(reader.open());
+    const auto &records = reader.lastRecords();
+    ASSERT_FALSE(records.isEmpty());
+    ASSERT_EQ(records.last().message, QString("message 999"));
+    for (int i = 0; i < records.size(); ++i)
+        ASSERT_EQ(records[i].message, QString("message %1").arg(1000 - records.size() + i));
+}
+
+TEST(ut_FlightRecorderAppender, testSurviveCrash)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.flight");
+
+    const pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+    if (pid == 0) {
+        FlightRecorderAppender appender(fileName, 64 * 1024);
+        for (int i = 0; i < 100; ++i)
+            appender.write(QDateTime::currentDateTime(), Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO, QString(), QString("message %1").arg(i));
+        raise(SIGKILL);
+    }
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    // the next run keeps the records of the crashed one.
+    FlightRecorderAppender appender(fileName, 64 * 1024);
+    FlightRecorderReader reader(fileName + ".1");
+    ASSERT_TRUE(reader.open());
+    const auto &records = reader.lastRecords(3);
+    ASSERT_EQ(records.size(), 3);
+    ASSERT_EQ(records.last().message, QString("message 99"));
+
+    FlightRecorderReader current(fileName);
+    ASSERT_TRUE(current.open());
+    ASSERT_TRUE(current.lastRecords().isEmpty());
+}
+
+TEST(ut_LogRateLimiter, testParseRules)
+{
+    QVector<LogRateLimiter::Rule> limits;
+    const QString &rules = LogRateLimiter::parseRules("dtk.*.debug=false;dtk.watcher.ratelimit=10/2;\n"
+                                                      "*.suppressrepeated=true;dtk.bad.ratelimit=many;dtk.test = true;"
+                                                      "dtk.bad;dtk.*.bad=true;dtk.bad.debug=maybe",
+                                                      &limits);
+    ASSERT_EQ(rules, QString("dtk.*.debug=false\ndtk.test=true"));
+    ASSERT_EQ(limits.size(), 2);
+    ASSERT_EQ(limits[0].category, QString("dtk.watcher"));
+    ASSERT_EQ(limits[0].count, 10);
+    ASSERT_EQ(limits[0].seconds, 2);
+    ASSERT_EQ(limits[0].suppressRepeated, -1);
+    ASSERT_EQ(limits[1].category, QString("*"));
+    ASSERT_EQ(limits[1].count, -1);
+    ASSERT_EQ(limits[1].suppressRepeated, 1);
+}
+
+TEST(ut_LogRateLimiter, testFilterRuleWildcards)
+{
+    QVector<LogRateLimiter::Rule> limits;
+    const QString &rules = LogRateLimiter::parseRules("*.debug=false;*dtk*.info=true;*=false;dtk.*=true;"
+                                                      "*.watcher.warning=true;d*k.debug=true;**=true;.debug=true",
+                                                      &limits);
+    ASSERT_EQ(rules, QString("*.debug=false\n*dtk*.info=true\n*=false\ndtk.*=true\n*.watcher.warning=true"));
+    ASSERT_TRUE(limits.isEmpty());
+}
+
+TEST(ut_LogRateLimiter, testTokenBucket)
+{
+    LogRateLimiter limiter;
+    QVector<LogRateLimiter::Rule> limits;
+    LogRateLimiter::parseRules("dtk.*.ratelimit=5", &limits);
+    limiter.setRules(limits);
+
+    QStringList summaries;
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i)
+        accepted += limiter.filter("dtk.test", QtWarningMsg, QString::number(i), 0, &summaries);
+    ASSERT_EQ(accepted, 5);
+    ASSERT_TRUE(summaries.isEmpty());
+
+    // other categories aren't limited.
+    for (int i = 0; i < 100; ++i)
+        ASSERT_TRUE(limiter.filter("other", QtWarningMsg, QString::number(i), 0, &summaries));
+    ASSERT_TRUE(limiter.filter("dtk.test", QtFatalMsg, "fatal", 0, &summaries));
+
+    // one token is refilled every 200ms.
+    ASSERT_FALSE(limiter.filter("dtk.test", QtWarningMsg, "later", 100, &summaries));
+    ASSERT_TRUE(limiter.filter("dtk.test", QtWarningMsg, "later", 200, &summaries));
+    ASSERT_EQ(summaries, QStringList{"96 messages were dropped by the rate limit of \"dtk.test\""});
+}
+
+TEST(ut_LogRateLimiter, testSuppressRepeated)
+{
+    LogRateLimiter limiter;
+    QVector<LogRateLimiter::Rule> limits;
+    LogRateLimiter::parseRules("dtk.test.suppressrepeated=true", &limits);
+    limiter.setRules(limits);
+
+    QStringList summaries;
+    int accepted = 0;
+    for (int i = 0; i < 100; ++i)
+        accepted += limiter.filter("dtk.test", QtWarningMsg, "inotify_add_watch failed", i, &summaries);
+    ASSERT_EQ(accepted, 1);
+    ASSERT_TRUE(limiter.filter("dtk.test", QtWarningMsg, "another message", 100, &summaries));
+    ASSERT_EQ(summaries, QStringList{"The previous message was repeated 99 times"});
+
+    // a long flood is summarized periodically.
+    summaries.clear();
+    for (int i = 0; i < 30; ++i)
+        limiter.filter("dtk.test", QtWarningMsg, "another message", 1000 + i * 1000, &summaries);
+    ASSERT_EQ(summaries.size(), 2);
+}
+
+TEST(ut_LogMetrics, testUtf8Size)
+{
+    for (const QString &message : {QString(), QString("ascii"), QString("中文 ü"), QString::fromUtf8("\xF0\x9F\x98\x80 emoji")})
+        ASSERT_EQ(LogMetrics::utf8Size(message), quint64(message.toUtf8().size()));
+}
+
+TEST(ut_LogMetrics, testCategoryAndAppender)
+{
+    LogMetrics::instance()->reset();
+    CategoryMetricsAppender categories;
+    auto target = new RecordingAppender;
+    InstrumentedAppender instrumented("test.recording", target);
+
+    for (int i = 0; i < 10; ++i) {
+        const QString &category = i % 2 ? "dtk.metrics.odd" : "dtk.metrics.even";
+        categories.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, category, "12345");
+        instrumented.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, category, "12345");
+    }
+    // filtered by the level of the target.
+    target->setDetailsLevel(Logger::Warning);
+    instrumented.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, QString(), "12345");
+
+    const QVariantMap &odd = LogMetrics::instance()->categories().value("dtk.metrics.odd").toMap();
+    ASSERT_EQ(odd.value("messages").toULongLong(), 5u);
+    ASSERT_EQ(odd.value("bytes").toULongLong(), 25u);
+
+    const QVariantMap &appender = LogMetrics::instance()->appenders().value("test.recording").toMap();
+    ASSERT_EQ(appender.value("messages").toULongLong(), 10u);
+    ASSERT_EQ(appender.value("bytes").toULongLong(), 50u);
+    ASSERT_GT(appender.value("nsecs").toULongLong(), 0u);
+    ASSERT_EQ(target->messages().size(), 10);
+
+    LogMetrics::instance()->reset();
+    ASSERT_EQ(LogMetrics::instance()->appenders().value("test.recording").toMap().value("messages").toULongLong(), 0u);
+}
+
+TEST(ut_LogMetrics, testRateLimitDropped)
+{
+    LogMetrics::instance()->reset();
+    LogRateLimiter limiter;
+    QVector<LogRateLimiter::Rule> limits;
+    LogRateLimiter::parseRules("dtk.metrics.limited.ratelimit=1", &limits);
+    limiter.setRules(limits);
+
+    QStringList summaries;
+    for (int i = 0; i < 10; ++i)
+        limiter.filter("dtk.metrics.limited", QtWarningMsg, QString::number(i), 0, &summaries);
+
+    const QVariantMap &limited = LogMetrics::instance()->categories().value("dtk.metrics.limited").toMap();
+    ASSERT_EQ(limited.value("dropped").toULongLong(), 9u);
+}
+
+TEST(ut_EarlyLogBuffer, testReleaseWithRules)
+{
+    EarlyLogBuffer buffer;
+    buffer.start();
+    ASSERT_TRUE(buffer.isBuffering());
+
+    const QLoggingCategory enabledCategory("dtk.early.enabled");
+    const QLoggingCategory disabledCategory("dtk.early.disabled");
+    // the debug messages of this category are disabled by its default severity.
+    const QLoggingCategory warningCategory("dtk.early.warning", QtWarningMsg);
+    const QMessageLogContext enabled(__FILE__, __LINE__, Q_FUNC_INFO, enabledCategory.categoryName());
+    const QMessageLogContext disabled(__FILE__, __LINE__, Q_FUNC_INFO, disabledCategory.categoryName());
+    const QMessageLogContext warning(__FILE__, __LINE__, Q_FUNC_INFO, warningCategory.categoryName());
+    ASSERT_TRUE(buffer.buffer(QtDebugMsg, enabled, "first"));
+    ASSERT_TRUE(buffer.buffer(QtDebugMsg, disabled, "second"));
+    ASSERT_TRUE(buffer.buffer(QtInfoMsg, enabled, "third"));
+    ASSERT_TRUE(buffer.buffer(QtDebugMsg, warning, "fourth"));
+    ASSERT_EQ(buffer.size(), 4);
+
+    // warnings and errors aren't held back.
+    ASSERT_FALSE(buffer.buffer(QtWarningMsg, enabled, "warning"));
+    ASSERT_FALSE(buffer.buffer(QtCriticalMsg, enabled, "critical"));
+    ASSERT_TRUE(buffer.isBuffering());
+    ASSERT_EQ(buffer.size(), 4);
+
+    QStringList messages;
+    auto appender = new RecordingAppender(0, &messages);
+    dlogger->registerAppender(appender);
+    QLoggingCategory::setFilterRules("dtk.early.disabled=false");
+    buffer.release();
+    dlogger->unregisterAppender(appender);
+    delete appender;
+    QLoggingCategory::setFilterRules(QString());
+
+    ASSERT_EQ(messages, QStringList({"first", "third"}));
+    ASSERT_FALSE(buffer.isBuffering());
+    ASSERT_FALSE(buffer.buffer(QtWarningMsg, enabled, "later"));
+}
+
+TEST(ut_EarlyLogBuffer, testReleaseWhenFull)
+{
+    EarlyLogBuffer buffer(2);
+    buffer.start();
+
+    const QMessageLogContext context(__FILE__, __LINE__, Q_FUNC_INFO, "dtk.early");
+    ASSERT_TRUE(buffer.buffer(QtDebugMsg, context, "1"));
+    ASSERT_TRUE(buffer.buffer(QtDebugMsg, context, "2"));
+    // full, everything is written and buffering stops.
+    ASSERT_FALSE(buffer.buffer(QtDebugMsg, context, "3"));
+    ASSERT_FALSE(buffer.isBuffering());
+    ASSERT_EQ(buffer.size(), 0);
+}
+
+TEST(ut_EarlyLogBuffer, testReleaseAfterTimeout)
+{
+    EarlyLogBuffer buffer;
+    buffer.start(50);
+
+    // no event loop runs, the next message after the timeout releases the buffer.
+    const QMessageLogContext context(__FILE__, __LINE__, Q_FUNC_INFO, "dtk.early");
+    ASSERT_TRUE(buffer.buffer(QtDebugMsg, context, "1"));
+    QThread::msleep(100);
+    ASSERT_FALSE(buffer.buffer(QtDebugMsg, context, "2"));
+    ASSERT_FALSE(buffer.isBuffering());
+    ASSERT_EQ(buffer.size(), 0);
+}
+
+static int filterCalls = 0;
+static QLoggingCategory::CategoryFilter previousFilter = nullptr;
+static void countingFilter(QLoggingCategory *category)
+{
+    ++filterCalls;
+    if (previousFilter)
+        previousFilter(category);
+}
+
+TEST(ut_LoggingRules, testSkipUnchangedRules)
+{
+    previousFilter = QLoggingCategory::installFilter(countingFilter);
+    LoggingRules rules;
+
+    ASSERT_TRUE(rules.apply("dtk.rules.debug=false;dtk.rules.limited.ratelimit=10"));
+    ASSERT_GT(filterCalls, 0);
+    ASSERT_EQ(rules.limits().size(), 1);
+
+    // the same rules written differently.
+    filterCalls = 0;
+    ASSERT_FALSE(rules.apply(" dtk.rules.debug = false \n dtk.rules.limited.ratelimit=10;"));
+    ASSERT_EQ(filterCalls, 0);
+
+    // only the rate limit changed.
+    ASSERT_TRUE(rules.apply("dtk.rules.debug=false"));
+    ASSERT_EQ(filterCalls, 0);
+    ASSERT_TRUE(rules.limits().isEmpty());
+
+    ASSERT_TRUE(rules.apply(QString()));
+    ASSERT_GT(filterCalls, 0);
+
+    QLoggingCategory::installFilter(previousFilter);
+}
+
+TEST(ut_LogCompressor, testGzip)
+{
+    const QByteArray &data = QByteArray("2026-10-19, 10:00:00.000 [Debug  ] value changed\n").repeated(1000);
+    const QByteArray &gzip = LogCompressor::gzip(data);
+    ASSERT_LT(gzip.size(), data.size() / 10);
+    ASSERT_EQ(quint8(gzip.at(0)), 0x1f);
+    ASSERT_EQ(quint8(gzip.at(1)), 0x8b);
+    ASSERT_EQ(qFromLittleEndian<quint32>(gzip.constData() + gzip.size() - 4), quint32(data.size()));
+    // the CRC-32 check value.
+    const QByteArray &check = LogCompressor::gzip("123456789");
+    ASSERT_EQ(qFromLittleEndian<quint32>(check.constData() + check.size() - 8), 0xcbf43926u);
+
+    // the same deflate stream as qCompress().
+    const QByteArray &zlib = qCompress(data);
+    ASSERT_EQ(gzip.mid(10, gzip.size() - 18), zlib.mid(6, zlib.size() - 10));
+}
+
+TEST(ut_LogCompressor, testGzipFile)
+{
+    QByteArray data;
+    for (int i = 0; i < 1000; ++i)
+        data += QByteArray::number(i) + " value changed\n";
+    QBuffer source(&data);
+    ASSERT_TRUE(source.open(QIODevice::ReadOnly));
+    QByteArray gzip;
+    QBuffer target(&gzip);
+    ASSERT_TRUE(target.open(QIODevice::WriteOnly));
+
+    // a gzip member for every chunk.
+    ASSERT_TRUE(LogCompressor::gzipFile(&source, &target, 4096));
+    QByteArray expected;
+    for (int pos = 0; pos < data.size(); pos += 4096)
+        expected += LogCompressor::gzip(data.mid(pos, 4096));
+    ASSERT_GT(data.size(), 2 * 4096);
+    ASSERT_EQ(gzip, expected);
+}
+
+TEST(ut_LogCompressor, testRotateBySize)
+{
+    QTemporaryDir dir;
+    const QString &fileName = dir.filePath("test.log");
+    {
+        FormattedRollingFileAppender appender(fileName, "%{message}\n");
+        appender.setDiskBudget(4096);
+        appender.setMaxFileSize(1024);
+        for (int i = 0; i < 2000; ++i) {
+            appender.write(QDateTime::currentDateTime(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, QString(),
+                           QString("message %1 %2").arg(i).arg(QString(40, QChar('x'))));
+        }
+        ASSERT_LT(QFileInfo(fileName).size(), 1024 + 100);
+    }
+    ASSERT_TRUE(LogCompressor::instance()->waitForDone(10000));
+
+    qint64 total = 0;
+    int compressed = 0;
+    for (const QFileInfo &file : QDir(dir.path()).entryInfoList({"test.log.*"}, QDir::Files)) {
+        ASSERT_TRUE(file.fileName().endsWith(".gz")) << qPrintable(file.fileName());
+        total += file.size();
+        ++compressed;
+    }
+    ASSERT_GT(compressed, 1);
+    ASSERT_LE(total, 4096);
+}
@@ -6,6 +6,8 @@
 #include <QFile>
 #include <QTextStream>
 #include <QJsonObject>
+#include <QJsonDocument>
+#include <QSignalSpy>
 #include "settings/dsettings.h"
 #include "settings/dsettingsoption.h"
 #include "settings/dsettingsgroup.h"
@@ -186,3 +188,35 @@ TEST_F(ut_DSettings, testDSettingReset)
     QVariant option = scopeSettings->getOption(keys[0]);
     ASSERT_TRUE(option.toBool());
 }
+
+TEST_F(ut_DSettings, testDSettingBatchUpdate)
+{
+    QPointer<DSettings> tmpSetting = DSettings::fromJson(jsonContent.toLatin1());
+    QScopedPointer<DSettings> scopeSettings(tmpSetting.data());
+    QSignalSpy valueSpy(scopeSettings.data(), &DSettings::valueChanged);
+    QSignalSpy valuesSpy(scopeSettings.data(), &DSettings::valuesChanged);
+    QStringList keys = scopeSettings->keys();
+
+    scopeSettings->beginUpdate();
+    scopeSettings->beginUpdate();
+    scopeSettings->setOption(keys[0], false);
+    scopeSettings->commit();
+    ASSERT_TRUE(scopeSettings->isUpdating());
+    ASSERT_EQ(valueSpy.count(), 0);
+    scopeSettings->commit();
+    ASSERT_FALSE(scopeSettings->isUpdating());
+
+    // the receivers of valueChanged still see every change.
+    ASSERT_EQ(valueSpy.count(), 1);
+    ASSERT_EQ(valueSpy.first().first().toString(), keys[0]);
+    ASSERT_EQ(valuesSpy.count(), 1);
+    QVariantMap values = valuesSpy.first().first().toMap();
+    ASSERT_EQ(values.value(keys[0]), QVariant(false));
+    ASSERT_FALSE(scopeSettings->getOption(keys[0]).toBool());
+
+    valueSpy.clear();
+    scopeSettings->reset();
+    ASSERT_EQ(valuesSpy.count(), 2);
+    ASSERT_GE(valueSpy.count(), 1);
+    ASSERT_TRUE(scopeSettings->getOption(keys[0]).toBool());
+}
@@ -6,6 +6,13 @@
 #include <QFile>
 #include <QTextStream>
 #include <QJsonObject>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QTemporaryDir>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include "test_helper.hpp"
 #include "settings/dsettings.h"
 #include "settings/dsettingsoption.h"
 #include "settings/dsettingsgroup.h"
@@ -88,3 +95,91 @@ TEST_F(ut_GSettings, testGSettingBackendGetOption)
 }
 
 
+
+// Use the in-memory gsettings backend with a schema compiled into a temporary directory.
+class ut_GSettingsMemory : public testing::Test
+{
+protected:
+    static constexpr int OptionCount = 64;
+    void SetUp() override;
+    void TearDown() override;
+    QTemporaryDir schemaDir;
+    EnvGuard schemaDirEnv;
+    EnvGuard backendEnv;
+    DSettings *settings = nullptr;
+    GSettingsBackend *gSettingBackend = nullptr;
+};
+
+void ut_GSettingsMemory::SetUp()
+{
+    QString schema = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+                     "<schemalist><schema id=\"com.deepin.dtk.test\" path=\"/com/deepin/dtk/test/\">";
+    QJsonArray options;
+    for (int i = 0; i < OptionCount; ++i) {
+        schema += QString("<key name=\"b-g-k%1\" type=\"i\"><default>0</default></key>").arg(i);
+        options.append(QJsonObject{{"key", QString("k%1").arg(i)}, {"type", "spinbutton"}, {"default", 0}});
+    }
+    schema += "</schema></schemalist>";
+
+    QFile file(schemaDir.filePath("com.deepin.dtk.test.gschema.xml"));
+    if (!file.open(QIODevice::WriteOnly))
+        GTEST_SKIP_("Can't write gsettings schema...");
+    file.write(schema.toUtf8());
+    file.close();
+
+    if (QProcess::execute("glib-compile-schemas", {schemaDir.path()}) != 0)
+        GTEST_SKIP_("glib-compile-schemas is not available...");
+
+    schemaDirEnv.set("GSETTINGS_SCHEMA_DIR", schemaDir.path().toLocal8Bit(), false);
+    backendEnv.set("GSETTINGS_BACKEND", "memory", false);
+
+    const QJsonObject meta {
+        {"gsettings", QJsonObject{{"id", "com.deepin.dtk.test"}, {"path", "/com/deepin/dtk/test/"}}},
+        {"groups", QJsonArray{QJsonObject{{"key", "b"}, {"groups", QJsonArray{
+            QJsonObject{{"key", "g"}, {"options", options}}}}}}}
+    };
+    settings = DSettings::fromJson(QJsonDocument(meta).toJson());
+    gSettingBackend = new GSettingsBackend(settings);
+}
+
+void ut_GSettingsMemory::TearDown()
+{
+    delete gSettingBackend;
+    gSettingBackend = nullptr;
+    delete settings;
+    settings = nullptr;
+}
+
+TEST_F(ut_GSettingsMemory, testGSettingBackendBatchWrite)
+{
+    for (int i = 0; i < OptionCount; ++i) {
+        Q_EMIT gSettingBackend->setOption(QString("b.g.k%1").arg(i), 1);
+        Q_EMIT gSettingBackend->setOption(QString("b.g.k%1").arg(i), 2);
+    }
+    QCoreApplication::processEvents();
+    // pending values are visible before they're applied.
+    ASSERT_EQ(gSettingBackend->getOption("b.g.k0").toInt(), 2);
+
+    gSettingBackend->doSync();
+    for (int i = 0; i < OptionCount; ++i)
+        ASSERT_EQ(gSettingBackend->getOption(QString("b.g.k%1").arg(i)).toInt(), 2);
+}
+
+TEST_F(ut_GSettingsMemory, testGSettingBackendWriteThroughput)
+{
+    constexpr int Rounds = 100;
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 1; round <= Rounds; ++round) {
+        QVariantMap values;
+        for (int i = 0; i < OptionCount; ++i)
+            values.insert(QString("b.g.k%1").arg(i), round);
+        gSettingBackend->doSetOptions(values);
+    }
+    const qint64 elapsed = qMax<qint64>(timer.elapsed(), 1);
+
+    ASSERT_EQ(gSettingBackend->getOption("b.g.k0").toInt(), Rounds);
+    const qint64 writesPerSecond = Rounds * OptionCount * 1000 / elapsed;
+    RecordProperty("writesPerSecond", QString::number(writesPerSecond).toStdString());
+    qInfo() << "GSettingsBackend writes per second:" << writesPerSecond;
+}
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "BinaryAppender.h"
+#include "FlightRecorderAppender.h"
+#include "LogFormatter.h"
+
+DCORE_USE_NAMESPACE
+
+#define DEFAULT_FMT "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("dtk-log-decoder");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode the binary log files written by DLogManager::registerBinaryFileAppender() and registerFlightRecorderAppender().");
+    parser.addHelpOption();
+    QCommandLineOption formatOption({"f", "format"}, "The format of the text lines, see AbstractStringAppender::setFormat().",
+                                    "format", DEFAULT_FMT);
+    parser.addOption(formatOption);
+    QCommandLineOption lastOption({"n", "last"}, "Only print the last <count> records of a flight recorder file.", "count", "-1");
+    parser.addOption(lastOption);
+    parser.addPositionalArgument("files", "The binary log or flight recorder files, e.g. ~/.cache/deepin/<app>/<app>.blog.1 ~/.cache/deepin/<app>/<app>.blog",
+                                 "files...");
+    parser.process(app);
+
+    const QStringList &files = parser.positionalArguments();
+    if (files.isEmpty())
+        parser.showHelp(1);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    const LogFormatter formatter(parser.value(formatOption));
+    auto print = [&](const BinaryLog::Record &record) {
+        out << formatter.formatted(record.time, record.level, record.file.constData(), record.line,
+                                   record.function.constData(), record.category, record.message)
+            << '\n';
+    };
+    int ret = 0;
+
+    for (const QString &file : files) {
+        if (FlightRecorderReader::isFlightRecorderFile(file)) {
+            FlightRecorderReader reader(file);
+            if (!reader.open()) {
+                err << file << ": " << reader.errorString() << '\n';
+                ret = 1;
+                continue;
+            }
+
+            for (const BinaryLog::Record &record : reader.lastRecords(parser.value(lastOption).toInt()))
+                print(record);
+            continue;
+        }
+
+        BinaryLogReader reader(file);
+        if (!reader.open()) {
+            err << file << ": " << reader.errorString() << '\n';
+            ret = 1;
+            continue;
+        }
+
+        BinaryLog::Record record;
+        while (reader.next(record))
+            print(record);
+        if (!reader.errorString().isEmpty()) {
+            err << file << ": " << reader.errorString() << '\n';
+            ret = 1;
+        }
+    }
+
+    out.flush();
+    err.flush();
+    return ret;
+}